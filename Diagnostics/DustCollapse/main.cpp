@@ -14,6 +14,7 @@
 #include <iostream>
 #include <regex>
 #include "AMReX_DataServices.H"
+#include <Castro_plot_compression.H>
 #include <DustCollapse_F.H>
 
 using namespace amrex;
@@ -25,6 +26,8 @@ Vector<size_t> sort_indexes(const Vector<T> &v);
 
 string GetVarFromJobInfo (const string pltfile, const string varname);
 
+int GetVarIndex (AmrData& data, const Vector<string>& zvarNames, const string varname);
+
 Vector<Real> GetCenter (const string pltfile);
 
 int main(int argc, char* argv[])
@@ -86,6 +89,10 @@ int main(int argc, char* argv[])
 		// get variable names
 		const Vector<string>& varNames = data.PlotVarNames();
 
+		// variables written with the lossy compressor are not part of the
+		// AmrData; we store them after the plotfile variables
+		const Vector<string> zvarNames = CompressedMultiFabNames(pltfile + "/Level_0/Cell_Z");
+
 		// get the index bounds and dx.
 		Box domain = data.ProbDomain()[finestLevel];
 		auto dx = data.CellSize(finestLevel);
@@ -125,7 +132,7 @@ int main(int argc, char* argv[])
 			r[i] = (i + 0.5) * dx_fine + rmin;
 
 		// find variable indices
-		auto dens_comp = data.StateNumber("density");
+		auto dens_comp = GetVarIndex(data, zvarNames, "density");
 
 		if (dens_comp < 0 )
 			Abort("ERROR: density variable not found");
@@ -162,9 +169,15 @@ int main(int argc, char* argv[])
 			const BoxArray& ba = data.boxArray(l);
 			const DistributionMapping& dm = data.DistributionMap(l);
 
-			MultiFab lev_data_mf(ba, dm, data.NComp(), data.NGrow());
+			MultiFab lev_data_mf(ba, dm, data.NComp() + zvarNames.size(), data.NGrow());
 			data.FillVar(lev_data_mf, l, varNames, fill_comps);
 
+			if (zvarNames.size() > 0) {
+				MultiFab zvar_mf;
+				ReadCompressedMultiFab(pltfile + "/Level_" + std::to_string(l) + "/Cell_Z", dm, zvar_mf);
+				MultiFab::Copy(lev_data_mf, zvar_mf, 0, data.NComp(), zvarNames.size(), 0);
+			}
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -344,6 +357,23 @@ string GetVarFromJobInfo (const string pltfile, const string varname) {
 	return "";
 }
 
+///
+/// Returns the index of the variable ``varname`` in the level data: the
+/// plotfile variables come first, followed by the compressed variables.
+/// Returns -1 if the variable is not found.
+///
+int GetVarIndex (AmrData& data, const Vector<string>& zvarNames, const string varname) {
+	auto comp = data.StateNumber(varname);
+	if (comp >= 0)
+		return comp;
+
+	for (auto i = 0; i < zvarNames.size(); i++)
+		if (zvarNames[i] == varname)
+			return data.NComp() + i;
+
+	return -1;
+}
+
 // Get the center from the job info file and return as a Real Vector
 Vector<Real> GetCenter (const string pltfile) {
 	auto center_str = GetVarFromJobInfo(pltfile, "center");
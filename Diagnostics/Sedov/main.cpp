@@ -6,6 +6,7 @@
 // #include <stringstream>
 #include <regex>
 #include "AMReX_DataServices.H"
+#include <Castro_plot_compression.H>
 #include <Sedov_F.H>
 
 using namespace amrex;
@@ -21,6 +22,8 @@ void GetInputArgs (const int argc, char** argv,
 
 string GetVarFromJobInfo (const string pltfile, const string varname);
 
+int GetVarIndex (AmrData& data, const Vector<string>& zvarNames, const string varname);
+
 Vector<Real> GetCenter (const string pltfile);
 
 void PrintHelp ();
@@ -62,6 +65,10 @@ int main(int argc, char* argv[])
 	// get variable names
 	const Vector<string>& varNames = data.PlotVarNames();
 
+	// variables written with the lossy compressor are not part of the
+	// AmrData; we store them after the plotfile variables
+	const Vector<string> zvarNames = CompressedMultiFabNames(pltfile + "/Level_0/Cell_Z");
+
 	// get the index bounds and dx.
 	Box domain = data.ProbDomain()[finestLevel];
 	Vector<Real> dx = data.CellSize(finestLevel);
@@ -97,16 +104,16 @@ int main(int argc, char* argv[])
 		r[i] = (i + 0.5) * dx_fine;
 
 	// find variable indices
-	auto dens_comp = data.StateNumber("density");
-	auto xmom_comp = data.StateNumber("xmom");
+	auto dens_comp = GetVarIndex(data, zvarNames, "density");
+	auto xmom_comp = GetVarIndex(data, zvarNames, "xmom");
 #if (AMREX_SPACEDIM >= 2)
-	auto ymom_comp = data.StateNumber("ymom");
+	auto ymom_comp = GetVarIndex(data, zvarNames, "ymom");
 #endif
 #if (AMREX_SPACEDIM == 3)
-	auto zmom_comp = data.StateNumber("zmom");
+	auto zmom_comp = GetVarIndex(data, zvarNames, "zmom");
 #endif
-	auto pres_comp = data.StateNumber("pressure");
-	auto rhoe_comp = data.StateNumber("rho_e");
+	auto pres_comp = GetVarIndex(data, zvarNames, "pressure");
+	auto rhoe_comp = GetVarIndex(data, zvarNames, "rho_e");
 
 	if (dens_comp < 0 || xmom_comp < 0 || pres_comp < 0 || rhoe_comp < 0)
 		Abort("ERROR: variable(s) not found");
@@ -150,9 +157,15 @@ int main(int argc, char* argv[])
 		const BoxArray& ba = data.boxArray(l);
 		const DistributionMapping& dm = data.DistributionMap(l);
 
-		MultiFab lev_data_mf(ba, dm, data.NComp(), data.NGrow());
+		MultiFab lev_data_mf(ba, dm, data.NComp() + zvarNames.size(), data.NGrow());
 		data.FillVar(lev_data_mf, l, varNames, fill_comps);
 
+		if (zvarNames.size() > 0) {
+			MultiFab zvar_mf;
+			ReadCompressedMultiFab(pltfile + "/Level_" + std::to_string(l) + "/Cell_Z", dm, zvar_mf);
+			MultiFab::Copy(lev_data_mf, zvar_mf, 0, data.NComp(), zvarNames.size(), 0);
+		}
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -357,6 +370,23 @@ string GetVarFromJobInfo (const string pltfile, const string varname) {
 	return "";
 }
 
+///
+/// Returns the index of the variable ``varname`` in the level data: the
+/// plotfile variables come first, followed by the compressed variables.
+/// Returns -1 if the variable is not found.
+///
+int GetVarIndex (AmrData& data, const Vector<string>& zvarNames, const string varname) {
+	auto comp = data.StateNumber(varname);
+	if (comp >= 0)
+		return comp;
+
+	for (auto i = 0; i < zvarNames.size(); i++)
+		if (zvarNames[i] == varname)
+			return data.NComp() + i;
+
+	return -1;
+}
+
 // Get the center from the job info file and return as a Real Vector
 Vector<Real> GetCenter (const string pltfile) {
 	auto center_str = GetVarFromJobInfo(pltfile, "center");
@@ -20,6 +20,10 @@
 #include <AMReX_TagBox.H>
 #include <AMReX_FillPatchUtil.H>
 #include <AMReX_ParmParse.H>
+#include <Castro_async_io.H>
+#include <Castro_eos_batch.H>
+#include <Castro_cost.H>
+#include <Castro_perf_log.H>
 
 #ifdef RADIATION
 #include "Radiation.H"
@@ -94,6 +98,9 @@ Gravity*     Castro::gravity  = 0;
 Diffusion*    Castro::diffusion  = 0;
 #endif
 
+// the asynchronous I/O writer
+AsyncWriter* Castro::async_writer = 0;
+
 #ifdef RADIATION
 int          Castro::do_radiation = -1;
 
@@ -128,12 +135,23 @@ IntVect      Castro::hydro_tile_size(1048576,1048576,1048576);
 IntVect      Castro::no_tile_size(1024,1024,1024);
 #endif
 
+Vector<std::string> Castro::plot_compressed_vars;
+
+Vector<std::string> Castro::insitu_vars;
+Vector<int> Castro::insitu_slice_normals;
+
 // this will be reset upon restart
 Real         Castro::previousCPUTimeUsed = 0.0;
 
 Real         Castro::startCPUTime = 0.0;
 
+#ifdef GRAVITY
+// this will be reset upon restart
+Real         Castro::total_energy_start = 0.0;
+#endif
+
 int          Castro::SDC_Source_Type = -1;
+int          Castro::Cost_Type = -1;
 int          Castro::num_state_type = 0;
 
 namespace amrex {
@@ -145,6 +163,21 @@ namespace amrex {
 void
 Castro::variableCleanUp ()
 {
+  // Make sure all outstanding asynchronous writes are on disk
+  // before we tear anything down.
+
+  if (async_writer != 0) {
+    if (verbose > 1 && ParallelDescriptor::IOProcessor()) {
+      std::cout << "Waiting for asynchronous I/O in variableCleanUp..." << '\n';
+    }
+    delete async_writer;
+    async_writer = 0;
+  }
+
+  if (verbose > 0 && buffer_pool_max_mb > 0.0) {
+    MultiFabPool::print_usage();
+  }
+
 #ifdef GRAVITY
   if (gravity != 0) {
     if (verbose > 1 && ParallelDescriptor::IOProcessor()) {
@@ -364,6 +397,25 @@ Castro::read_params ()
     }
 #endif
 
+    if (hydro_tile_local_prim == 1) {
+        if (time_integration_method != CornerTransportUpwind &&
+            time_integration_method != SimplifiedSpectralDeferredCorrections) {
+            amrex::Error("hydro_tile_local_prim requires the CTU or simplified SDC time integration method");
+        }
+#ifdef RADIATION
+        amrex::Error("hydro_tile_local_prim is not supported with radiation");
+#endif
+    }
+
+    if (hydro_overlap_comm == 1) {
+        if (hydro_tile_local_prim != 1) {
+            amrex::Error("hydro_overlap_comm requires hydro_tile_local_prim = 1");
+        }
+        if (time_integration_method != CornerTransportUpwind) {
+            amrex::Error("hydro_overlap_comm requires the CTU time integration method");
+        }
+    }
+
     if (hybrid_riemann == 1 && BL_SPACEDIM == 1)
       {
         std::cerr << "hybrid_riemann only implemented in 2- and 3-d\n";
@@ -451,6 +503,27 @@ Castro::read_params ()
         for (int i=0; i<BL_SPACEDIM; i++) hydro_tile_size[i] = tilesize[i];
     }
 
+    int nvars = pp.countval("plot_compressed_vars");
+    if (nvars > 0) {
+        pp.getarr("plot_compressed_vars", plot_compressed_vars, 0, nvars);
+    }
+
+    if (plot_compression_tol <= 1.e-15 || plot_compression_floor <= 0.0) {
+        amrex::Error("castro.plot_compression_tol must be > 1.e-15 and castro.plot_compression_floor must be > 0");
+    }
+
+    nvars = pp.countval("insitu_vars");
+    if (nvars > 0) {
+        pp.getarr("insitu_vars", insitu_vars, 0, nvars);
+    }
+
+    const int nslices = pp.countval("insitu_slice_normals");
+    if (nslices > 0) {
+        pp.getarr("insitu_slice_normals", insitu_slice_normals, 0, nslices);
+    }
+
+    MultiFabPool::set_max_bytes(static_cast<Long>(buffer_pool_max_mb * 1024.0 * 1024.0));
+
     // Override Amr defaults. Note: this function is called after Amr::Initialize()
     // in Amr::InitAmr(), right before the ParmParse checks, so if the user opts to
     // override our overriding, they can do so.
@@ -463,6 +536,7 @@ Castro::Castro ()
     :
     prev_state(num_state_type)
 {
+    derive_cache.setBudget(static_cast<Long>(derive_cache_max_mb * 1024.0 * 1024.0));
 }
 
 Castro::Castro (Amr&            papa,
@@ -481,6 +555,8 @@ Castro::Castro (Amr&            papa,
 
     initMFs();
 
+    derive_cache.setBudget(static_cast<Long>(derive_cache_max_mb * 1024.0 * 1024.0));
+
     for (int i = 0; i < n_lost; i++) {
       material_lost_through_boundary_cumulative[i] = 0.0;
       material_lost_through_boundary_temp[i] = 0.0;
@@ -899,6 +975,10 @@ Castro::initData ()
     React_new.setVal(0.);
 #endif
 
+    if (Cost_Type >= 0) {
+        get_new_data(Cost_Type).setVal(0.0);
+    }
+
 #ifdef SIMPLIFIED_SDC
 #ifdef REACTIONS
    if (time_integration_method == SimplifiedSpectralDeferredCorrections) {
@@ -1250,6 +1330,8 @@ Castro::init (AmrLevel &old)
 {
     BL_PROFILE("Castro::init(old)");
 
+    PerfRegion perf_region(PerfLog::Regrid);
+
     Castro* oldlev = (Castro*) &old;
 
     //
@@ -1277,6 +1359,8 @@ Castro::init ()
 {
     BL_PROFILE("Castro::init()");
 
+    PerfRegion perf_region(PerfLog::Regrid);
+
     Real dt        = parent->dtLevel(level);
     Real cur_time  = getLevel(level-1).state[State_Type].curTime();
     Real prev_time = getLevel(level-1).state[State_Type].prevTime();
@@ -1504,6 +1588,11 @@ Castro::computeNewDt (int                   finest_level,
     if (level > 0)
         return;
 
+    // The previous step and its output are done, so its record
+    // can be written.
+
+    PerfLog::flush();
+
     Real dt_0 = 1.0e+100;
     int n_factor = 1;
     for (int i = 0; i <= finest_level; i++)
@@ -1739,6 +1828,25 @@ Castro::computeInitialDt (int                   finest_level,
     }
 }
 
+bool
+Castro::output_due (int nstep, Real cumtime, Real dtlev, int interval, Real period)
+{
+    if (interval > 0 && nstep % interval == 0)
+        return true;
+
+    if (period > 0.0) {
+
+        const int num_per_old = floor((cumtime - dtlev) / period);
+        const int num_per_new = floor((cumtime        ) / period);
+
+        if (num_per_old != num_per_new)
+            return true;
+
+    }
+
+    return false;
+}
+
 void
 Castro::post_timestep (int iteration)
 {
@@ -1801,36 +1909,26 @@ Castro::post_timestep (int iteration)
 
 #endif
 
+    // The state on this level and the ones above it has changed
+    // through reflux, average down and the hooks above, so anything
+    // derived from it during the step is stale.
+
+    for (int lev = level; lev <= parent->finestLevel(); lev++) {
+        getLevel(lev).derive_cache.clear();
+    }
+
     if (level == 0)
     {
         int nstep = parent->levelSteps(0);
         Real dtlev = parent->dtLevel(0);
         Real cumtime = parent->cumTime() + dtlev;
 
-        bool sum_int_test = false;
-
-        if (sum_interval > 0) {
-
-          if (nstep%sum_interval == 0)
-            sum_int_test = true;
-
-        }
-
-        bool sum_per_test = false;
-
-        if (sum_per > 0.0) {
-
-          const int num_per_old = floor((cumtime - dtlev) / sum_per);
-          const int num_per_new = floor((cumtime        ) / sum_per);
-
-          if (num_per_old != num_per_new)
-            sum_per_test = true;
-
-        }
-
-        if (sum_int_test || sum_per_test)
+        if (output_due(nstep, cumtime, dtlev, sum_interval, sum_per))
           sum_integrated_quantities();
 
+        if (output_due(nstep, cumtime, dtlev, insitu_interval, insitu_per))
+          insitu_output();
+
 #ifdef GRAVITY
         if (moving_center) write_center();
 #endif
@@ -1867,6 +1965,8 @@ Castro::post_restart ()
 {
    BL_PROFILE("Castro::post_restart()");
 
+   derive_cache.clear();
+
    Real cur_time = state[State_Type].curTime();
 
 #ifdef AMREX_PARTICLES
@@ -1955,6 +2055,14 @@ Castro::post_restart ()
     problem_post_restart();
 #endif
 
+#ifdef GRAVITY
+    set_total_energy_start();
+#endif
+
+    if (level == 0) {
+        PerfLog::init(perf_log_file, true);
+    }
+
 }
 
 void
@@ -1967,6 +2075,31 @@ Castro::postCoarseTimeStep (Real cumtime)
     if (do_grav)
         gravity->set_mass_offset(cumtime, 0);
 #endif
+
+    // Finish off any asynchronous output that is now on disk everywhere.
+
+    if (async_writer != 0) {
+        async_writer->completeOutputs();
+    }
+
+    if (PerfLog::enabled()) {
+        const int finest_level = parent->finestLevel();
+
+        Vector<Long> mlmg_iters(finest_level + 1, 0);
+#ifdef GRAVITY
+        if (do_grav) {
+            for (int lev = 0; lev <= finest_level; ++lev) {
+                mlmg_iters[lev] = gravity->get_total_mlmg_iters(lev);
+            }
+        }
+#endif
+
+        // The record is written at the start of the next step (or after
+        // the final output), so that it includes the plotfiles and
+        // checkpoints that Amr writes after this.
+
+        PerfLog::end_step(parent->levelSteps(0), cumtime, parent->dtLevel(0), finest_level, mlmg_iters);
+    }
 }
 
 void
@@ -2056,8 +2189,12 @@ Castro::post_regrid (int lbase,
 
     BL_PROFILE("Castro::post_regrid()");
 
+    PerfRegion perf_region(PerfLog::Regrid);
+
     fine_mask.clear();
 
+    derive_cache.clear();
+
 #ifdef AMREX_PARTICLES
     if (TracerPC && level == lbase) {
         TracerPC->Redistribute(lbase);
@@ -2233,39 +2370,31 @@ Castro::post_init (Real stop_time)
 #endif
 #endif
 
+    for (int lev = 0; lev <= parent->finestLevel(); lev++) {
+        getLevel(lev).derive_cache.clear();
+    }
+
         int nstep = parent->levelSteps(0);
         Real dtlev = parent->dtLevel(0);
         Real cumtime = parent->cumTime();
         if (cumtime != 0.0) cumtime += dtlev;
 
-        bool sum_int_test = false;
-
-        if (sum_interval > 0) {
-
-          if (nstep%sum_interval == 0)
-            sum_int_test = true;
-
-        }
-
-        bool sum_per_test = false;
-
-        if (sum_per > 0.0) {
-
-          const int num_per_old = floor((cumtime - dtlev) / sum_per);
-          const int num_per_new = floor((cumtime        ) / sum_per);
-
-          if (num_per_old != num_per_new)
-            sum_per_test = true;
-
-        }
+#ifdef GRAVITY
+        set_total_energy_start();
+#endif
 
-        if (sum_int_test || sum_per_test)
+        if (output_due(nstep, cumtime, dtlev, sum_interval, sum_per))
           sum_integrated_quantities();
 
+        if (output_due(nstep, cumtime, dtlev, insitu_interval, insitu_per))
+          insitu_output();
+
 #ifdef GRAVITY
     if (level == 0 && moving_center == 1)
        write_center();
 #endif
+
+    PerfLog::init(perf_log_file, false);
 }
 
 void
@@ -2676,7 +2805,7 @@ Castro::reflux(int crse_level, int fine_level)
 
             if (getLevel(lev).apply_sources()) {
 
-                getLevel(lev).apply_source_to_state(S_new, source, -dt_advance_local, 0);
+                getLevel(lev).apply_source_to_state(S_new, source, -dt_advance_local, 0, true);
                 getLevel(lev).clean_state(S_new, time, 0);
 
             }
@@ -2690,17 +2819,16 @@ Castro::reflux(int crse_level, int fine_level)
 
                     if (getLevel(lev).prev_state[k]->hasOldData()) {
 
-                        // Use the new-time data as a temporary buffer. Ideally this would be done
-                        // as a pointer swap, but we cannot assume that the distribution mapping
-                        // is the same between the current state and the original state, due to
-                        // possible regrids that have occurred in between.
+                        // Swap in the last iteration's old data; prev_state holds the
+                        // original old data until we swap them back below. Like a copy
+                        // between them, this requires that the two have the same layout.
+
+                        AMREX_ASSERT(getLevel(lev).prev_state[k]->oldData().boxArray() == getLevel(lev).get_old_data(k).boxArray());
+                        AMREX_ASSERT(getLevel(lev).prev_state[k]->oldData().DistributionMap() == getLevel(lev).get_old_data(k).DistributionMap());
 
-                        MultiFab& old = getLevel(lev).get_old_data(k);
-                        MultiFab::Copy(getLevel(lev).prev_state[k]->newData(), old, 0, 0, old.nComp(), old.nGrow());
-                        MultiFab::Copy(old, getLevel(lev).prev_state[k]->oldData(), 0, 0, old.nComp(), old.nGrow());
+                        getLevel(lev).state[k].replaceOldData(*getLevel(lev).prev_state[k]);
 
                         getLevel(lev).state[k].setTimeLevel(time, dt_advance_local, 0.0);
-                        getLevel(lev).prev_state[k]->setTimeLevel(time, dt_amr, 0.0);
 
                     }
 
@@ -2721,11 +2849,9 @@ Castro::reflux(int crse_level, int fine_level)
 
                         // Now retrieve the original old time data.
 
-                        MultiFab& old = getLevel(lev).get_old_data(k);
-                        MultiFab::Copy(old, getLevel(lev).prev_state[k]->newData(), 0, 0, old.nComp(), old.nGrow());
+                        getLevel(lev).state[k].replaceOldData(*getLevel(lev).prev_state[k]);
 
                         getLevel(lev).state[k].setTimeLevel(time, dt_amr, 0.0);
-                        getLevel(lev).prev_state[k]->setTimeLevel(time, dt_advance_local, 0.0);
 
                     }
 
@@ -2927,6 +3053,8 @@ Castro::avgDown (int state_indx)
     amrex::average_down(S_fine, S_crse,
                          fgeom, cgeom,
                          0, S_fine.nComp(), fine_ratio);
+
+    derive_cache.clear();
 }
 
 void
@@ -2954,6 +3082,8 @@ Castro::errorEst (TagBoxArray& tags,
 {
     BL_PROFILE("Castro::errorEst()");
 
+    PerfRegion perf_region(PerfLog::Regrid);
+
     ca_set_amr_info(level, -1, -1, -1.0, -1.0);
 
     Real ltime = time;
@@ -3133,11 +3263,49 @@ Castro::derive (const std::string& name,
 
     BL_PROFILE("Castro::derive()");
 
+    // Only quantities in derive_lst that are computed from State_Type
+    // alone are cached, since the cache is cleared when that changes.
+    // This leaves out the particle quantities, which are not in
+    // derive_lst, and anything that depends on other state data.
+
+    bool use_cache = false;
+
+    if (derive_cache.enabled()) {
+        const DeriveRec* rec = derive_lst.get(name);
+        if (rec != nullptr && rec->numRange() > 0) {
+            use_cache = true;
+            for (int k = 0; k < rec->numRange(); ++k) {
+                int index, scomp, ncomp;
+                rec->getRange(k, index, scomp, ncomp);
+                if (index != State_Type) {
+                    use_cache = false;
+                }
+            }
+        }
+    }
+
+    if (use_cache) {
+        const MultiFab* cached = derive_cache.find(name, time, ngrow);
+        if (cached != nullptr) {
+            // Callers are free to modify what we return, so hand back a copy.
+            std::unique_ptr<MultiFab> mf(new MultiFab(cached->boxArray(), cached->DistributionMap(),
+                                                      cached->nComp(), cached->nGrow()));
+            MultiFab::Copy(*mf, *cached, 0, 0, cached->nComp(), cached->nGrow());
+            return mf;
+        }
+    }
+
 #ifdef AMREX_PARTICLES
-  return ParticleDerive(name,time,ngrow);
+    std::unique_ptr<MultiFab> mf = ParticleDerive(name,time,ngrow);
 #else
-   return AmrLevel::derive(name,time,ngrow);
+    std::unique_ptr<MultiFab> mf = AmrLevel::derive(name,time,ngrow);
 #endif
+
+    if (use_cache && mf) {
+        derive_cache.insert(name, time, *mf);
+    }
+
+    return mf;
 }
 
 void
@@ -3194,15 +3362,12 @@ Castro::reset_internal_energy(const Box& bx, Array4<Real> const u)
     Real lsmall_temp = small_temp;
     Real ldual_energy_eta2 = dual_energy_eta2;
 
-    AMREX_PARALLEL_FOR_3D(bx, i, j, k,
+    // Find the minimum internal energy from the EOS at small_temp, then
+    // apply the floors and the dual energy criterion.
+
+    auto eos_gather = [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k, eos_t& eos_state)
     {
         Real rhoInv = 1.0_rt / u(i,j,k,URHO);
-        Real Up = u(i,j,k,UMX) * rhoInv;
-        Real Vp = u(i,j,k,UMY) * rhoInv;
-        Real Wp = u(i,j,k,UMZ) * rhoInv;
-        Real ke = 0.5_rt * (Up * Up + Vp * Vp + Wp * Wp);
-
-        eos_t eos_state;
 
         eos_state.rho = u(i,j,k,URHO);
         eos_state.T   = lsmall_temp;
@@ -3212,8 +3377,15 @@ Castro::reset_internal_energy(const Box& bx, Array4<Real> const u)
         for (int n = 0; n < NumAux; ++n) {
             eos_state.aux[n] = u(i,j,k,UFX+n) * rhoInv;
         }
+    };
 
-        eos(eos_input_rt, eos_state);
+    auto eos_scatter = [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k, eos_t const& eos_state)
+    {
+        Real rhoInv = 1.0_rt / u(i,j,k,URHO);
+        Real Up = u(i,j,k,UMX) * rhoInv;
+        Real Vp = u(i,j,k,UMY) * rhoInv;
+        Real Wp = u(i,j,k,UMZ) * rhoInv;
+        Real ke = 0.5_rt * (Up * Up + Vp * Vp + Wp * Wp);
 
         Real small_e = eos_state.e;
 
@@ -3230,7 +3402,9 @@ Castro::reset_internal_energy(const Box& bx, Array4<Real> const u)
         if (rho_eint > ldual_energy_eta2 * u(i,j,k,UEDEN)) {
             u(i,j,k,UEINT) = rho_eint;
         }
-    });
+    };
+
+    eos_apply(bx, eos_input_rt, eos_batch_enabled(eos_batch_reset_eint), eos_gather, eos_scatter);
 }
 
 void
@@ -3361,6 +3535,11 @@ Castro::computeTemp(MultiFab& State, Real time, int ng)
   }
 #endif
 
+  // computeTemp is also used on states that are not on this level's
+  // grids, and those are not timed.
+
+  MultiFab* cost = (State.boxArray() == grids && State.DistributionMap() == dmap) ? cost_data() : nullptr;
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -3377,6 +3556,8 @@ Castro::computeTemp(MultiFab& State, Real time, int ng)
 
       const Box& bx = mfi.growntilebox(num_ghost);
 
+      CostTimer cost_timer(cost, mfi, bx);
+
 #ifdef TRUE_SDC
       FArrayBox& u_fab = (sdc_order == 4) ? Stemp[mfi] : State[mfi];
 #else
@@ -3385,13 +3566,10 @@ Castro::computeTemp(MultiFab& State, Real time, int ng)
 
       Array4<Real> const u = u_fab.array();
 
-      AMREX_PARALLEL_FOR_3D(bx, i, j, k,
+      auto eos_gather = [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k, eos_t& eos_state)
       {
-
           Real rhoInv = 1.0_rt / u(i,j,k,URHO);
 
-          eos_t eos_state;
-
           eos_state.rho = u(i,j,k,URHO);
           eos_state.T   = u(i,j,k,UTEMP); // Initial guess for the EOS
           eos_state.e   = u(i,j,k,UEINT) * rhoInv;
@@ -3399,12 +3577,14 @@ Castro::computeTemp(MultiFab& State, Real time, int ng)
               eos_state.xn[n] = u(i,j,k,UFS+n) * rhoInv;
           for (int n = 0; n < NumAux; ++n)
               eos_state.aux[n] = u(i,j,k,UFX+n) * rhoInv;
+      };
 
-          eos(eos_input_re, eos_state);
-
+      auto eos_scatter = [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k, eos_t const& eos_state)
+      {
           u(i,j,k,UTEMP) = eos_state.T;
+      };
 
-      });
+      eos_apply(bx, eos_input_re, eos_batch_enabled(eos_batch_compute_temp), eos_gather, eos_scatter);
 
       if (clamp_ambient_temp == 1) {
 #pragma gpu box(bx)
@@ -3846,6 +4026,83 @@ Castro::expand_state(MultiFab& S, Real time, int ng)
 }
 
 
+
+bool
+Castro::overlap_sborder_fill()
+{
+  // Sborder's ghost zones must not be needed before the hydro: a fine
+  // level needs the coarse level for its ghost zones, the burn works on
+  // the ghost zones, and S_new is initialized from them if it has any.
+
+  if (hydro_overlap_comm != 1 || level > 0 || !do_hydro) {
+    return false;
+  }
+
+  if (time_integration_method != CornerTransportUpwind) {
+    return false;
+  }
+
+  if (get_new_data(State_Type).nGrow() > 0) {
+    return false;
+  }
+
+  // The old-time sources are computed from Sborder before the hydro.
+
+  if (apply_sources()) {
+    return false;
+  }
+
+#ifdef REACTIONS
+  if (do_react == 1) {
+    return false;
+  }
+#endif
+
+  return true;
+}
+
+
+void
+Castro::start_sborder_fill(Real time)
+{
+  BL_PROFILE("Castro::start_sborder_fill()");
+
+  BL_ASSERT(level == 0);
+  BL_ASSERT(time == state[State_Type].prevTime());
+
+  MultiFab::Copy(Sborder, get_old_data(State_Type), 0, 0, NUM_STATE, 0);
+
+#ifdef SHOCK_VAR
+  // Zero the shock data before it is sent to the neighbors.
+  Sborder.setVal(0.0, USHK, 1, 0);
+#endif
+
+  Sborder.FillBoundary_nowait(geom.periodicity());
+
+  sborder_fill_pending = true;
+}
+
+
+void
+Castro::finish_sborder_fill(Real time)
+{
+  if (!sborder_fill_pending) return;
+
+  BL_PROFILE("Castro::finish_sborder_fill()");
+
+  const Real strt_time = ParallelDescriptor::second();
+
+  Sborder.FillBoundary_finish();
+
+  StateDataPhysBCFunct physbcf(state[State_Type], 0, geom);
+  physbcf(Sborder, 0, NUM_STATE, Sborder.nGrowVect(), time, 0);
+
+  sborder_fill_pending = false;
+
+  sborder_fill_wait += ParallelDescriptor::second() - strt_time;
+}
+
+
 void
 Castro::check_for_nan(MultiFab& state_in, int check_ghost)
 {
@@ -1,6 +1,7 @@
 
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_perf_log.H"
 
 #ifdef RADIATION
 #include "Radiation.H"
@@ -46,6 +47,13 @@ Castro::advance (Real time,
 
     Real dt_new = dt;
 
+    // The state data is about to change, so drop any derived quantities,
+    // and do not cache anything while it is being advanced.
+
+    derive_cache.clear();
+
+    DeriveCache::suspend(true);
+
     initialize_advance(time, dt, amr_iteration, amr_ncycle);
 
     // Do the advance.
@@ -110,6 +118,12 @@ Castro::advance (Real time,
 
     finalize_advance(time, dt, amr_iteration, amr_ncycle);
 
+    derive_cache.clear();
+
+    DeriveCache::suspend(false);
+
+    PerfLog::add_zones(level, grids.numPts());
+
     return dt_new;
 }
 
@@ -123,6 +137,11 @@ Castro::initialize_do_advance(Real time, Real dt, int amr_iteration, int amr_ncy
     // Reset the CFL violation flag.
 
     cfl_violation = 0;
+    max_courant = 0.0;
+    max_courant_key = 0;
+
+    sborder_fill_pending = false;
+    sborder_fill_wait = 0.0;
 
 #ifdef RADIATION
     // make sure these are filled to avoid check/plot file errors:
@@ -165,14 +184,24 @@ Castro::initialize_do_advance(Real time, Real dt, int amr_iteration, int amr_ncy
       // state note: a clean_state has already been done on the old
       // state in initialize_advance so we don't need to do another
       // one here
-      Sborder.define(grids, dmap, NUM_STATE, NUM_GROW, MFInfo().SetTag("Sborder"));
+      buffer_pool.define(Sborder, "Sborder", grids, dmap, NUM_STATE, NUM_GROW);
       const Real prev_time = state[State_Type].prevTime();
-      expand_state(Sborder, prev_time, NUM_GROW);
+
+      if (overlap_sborder_fill()) {
+          // the ghost zones are finished by the hydro, once it has
+          // done the tiles that do not need them
+          start_sborder_fill(prev_time);
+      }
+      else {
+          const Real strt_time = ParallelDescriptor::second();
+          expand_state(Sborder, prev_time, NUM_GROW);
+          sborder_fill_wait = ParallelDescriptor::second() - strt_time;
+      }
 
     } else if (time_integration_method == SpectralDeferredCorrections) {
 
       // we'll handle the filling inside of do_advance_sdc 
-      Sborder.define(grids, dmap, NUM_STATE, NUM_GROW, MFInfo().SetTag("Sborder"));
+      buffer_pool.define(Sborder, "Sborder", grids, dmap, NUM_STATE, NUM_GROW);
 
     } else {
       amrex::Abort("invalid time_integration_method");
@@ -183,7 +212,12 @@ Castro::initialize_do_advance(Real time, Real dt, int amr_iteration, int amr_ncy
     // For subcycling cases this will always give the shock
     // variable for the latest subcycle, rather than averaging.
 
-    Sborder.setVal(0.0, USHK, 1, Sborder.nGrow());
+    // If the ghost zones are still being filled, the shock data
+    // was already zeroed before the exchange started.
+
+    if (!sborder_fill_pending) {
+        Sborder.setVal(0.0, USHK, 1, Sborder.nGrow());
+    }
 #endif
 
 }
@@ -203,7 +237,11 @@ Castro::finalize_do_advance(Real time, Real dt, int amr_iteration, int amr_ncycl
     }
 #endif
 
-    Sborder.clear();
+    // Normally the hydro has already completed the ghost zone exchange.
+
+    finish_sborder_fill(state[State_Type].prevTime());
+
+    buffer_pool.release(Sborder, "Sborder");
 
 }
 
@@ -275,18 +313,25 @@ Castro::initialize_advance(Real time, Real dt, int amr_iteration, int amr_ncycle
     // This array holds the sum of all source terms that affect the
     // hydrodynamics.
 
-    sources_for_hydro.define(grids, dmap, NSRC, NUM_GROW);
+    buffer_pool.define(sources_for_hydro, "sources_for_hydro", grids, dmap, NSRC, NUM_GROW);
     sources_for_hydro.setVal(0.0, NUM_GROW);
 
     // This array holds the source term corrector.
 
-    source_corrector.define(grids, dmap, NSRC, NUM_GROW);
+    buffer_pool.define(source_corrector, "source_corrector", grids, dmap, NSRC, NUM_GROW);
     source_corrector.setVal(0.0, NUM_GROW);
 
     // Swap the new data from the last timestep into the old state data.
 
     swap_state_time_levels(dt);
 
+    // The cost estimate is the time spent on this advance (including
+    // any retries), so start it over.
+
+    if (Cost_Type >= 0) {
+        get_new_data(Cost_Type).setVal(0.0);
+    }
+
 #ifdef GRAVITY
     if (do_grav)
         gravity->swapTimeLevels(level);
@@ -309,15 +354,18 @@ Castro::initialize_advance(Real time, Real dt, int amr_iteration, int amr_ncycle
 
     // This array holds the hydrodynamics update.
     if (time_integration_method == CornerTransportUpwind || time_integration_method == SimplifiedSpectralDeferredCorrections) {
-      hydro_source.define(grids,dmap,NUM_STATE,0);
+      buffer_pool.define(hydro_source, "hydro_source", grids, dmap, NUM_STATE, 0);
     }
 
 
-    // Allocate space for the primitive variables.
+    // Allocate space for the primitive variables, unless the hydro
+    // computes them tile by tile.
 
-    q.define(grids, dmap, NQ, NUM_GROW);
-    q.setVal(0.0);
-    qaux.define(grids, dmap, NQAUX, NUM_GROW);
+    if (hydro_tile_local_prim == 0) {
+        buffer_pool.define(q, "q", grids, dmap, NQ, NUM_GROW);
+        q.setVal(0.0);
+        buffer_pool.define(qaux, "qaux", grids, dmap, NQAUX, NUM_GROW);
+    }
 
 
     if (sdc_order == 4) {
@@ -420,11 +468,11 @@ Castro::finalize_advance(Real time, Real dt, int amr_iteration, int amr_ncycle)
 
 
     if (time_integration_method == CornerTransportUpwind || time_integration_method == SimplifiedSpectralDeferredCorrections) {
-      hydro_source.clear();
+      buffer_pool.release(hydro_source, "hydro_source");
     }
 
-    q.clear();
-    qaux.clear();
+    buffer_pool.release(q, "q");
+    buffer_pool.release(qaux, "qaux");
 
     if (sdc_order == 4) {
       q_bar.clear();
@@ -439,8 +487,8 @@ Castro::finalize_advance(Real time, Real dt, int amr_iteration, int amr_ncycle)
     lamborder.clear();
 #endif
 
-    source_corrector.clear();
-    sources_for_hydro.clear();
+    buffer_pool.release(source_corrector, "source_corrector");
+    buffer_pool.release(sources_for_hydro, "sources_for_hydro");
 
     if (!keep_prev_state)
         amrex::FillNull(prev_state);
@@ -1,6 +1,7 @@
 
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_perf_log.H"
 
 #ifdef RADIATION
 #include "Radiation.H"
@@ -61,7 +62,9 @@ Castro::do_advance_ctu(Real time,
     }
     else if (time_integration_method == SimplifiedSpectralDeferredCorrections) {
         // Time center the sources.
-        MultiFab::Add(sources_for_hydro, source_corrector, 0, 0, NSRC, NUM_GROW);
+        for (const auto& range : source_component_ranges()) {
+            MultiFab::Add(sources_for_hydro, source_corrector, range.first, range.first, range.second, NUM_GROW);
+        }
     }
 
 #ifndef AMREX_USE_CUDA
@@ -85,21 +88,19 @@ Castro::do_advance_ctu(Real time,
 #endif
 
     // Initialize the new-time data. This copy needs to come after the
-    // reactions.
+    // reactions. It cannot be replaced by a swap: the old-time sources
+    // and the hydro still read Sborder as the input state while they
+    // accumulate their updates into S_new.
 
     MultiFab::Copy(S_new, Sborder, 0, 0, NUM_STATE, S_new.nGrow());
 
 #ifdef REACTIONS
     if (time_integration_method != SimplifiedSpectralDeferredCorrections) {
 
-        // Do this for the reactions as well, in case we cut the timestep
-        // short due to it being rejected.
-
-        MultiFab& R_old = get_old_data(Reactions_Type);
-        MultiFab& R_new = get_new_data(Reactions_Type);
-        MultiFab::Copy(R_new, R_old, 0, 0, R_new.nComp(), R_new.nGrow());
-
         // Skip the rest of the advance if the burn was unsuccessful.
+        // The new-time reactions data is only written by the second
+        // half of the burn; if we stop before it, the caller fills
+        // it from the old-time data.
 
         if (!burn_success) {
             status.success = false;
@@ -134,7 +135,9 @@ Castro::do_advance_ctu(Real time,
       // terms (e.g. the source term predictor, or the SDC source).
 
      if (do_hydro) {
-         AmrLevel::FillPatchAdd(*this, sources_for_hydro, NUM_GROW, time, Source_Type, 0, NSRC);
+         for (const auto& range : source_component_ranges()) {
+             AmrLevel::FillPatchAdd(*this, sources_for_hydro, NUM_GROW, time, Source_Type, range.first, range.second, range.first);
+         }
      }
 
     } else {
@@ -148,20 +151,34 @@ Castro::do_advance_ctu(Real time,
 
     if (do_hydro)
     {
-      // Construct the primitive variables.
-      cons_to_prim(time);
+      if (hydro_tile_local_prim == 0) {
 
-      // Check for CFL violations.
-      check_for_cfl_violation(dt);
+          // Construct the primitive variables; this also finds the
+          // largest Courant number on the level.
+          cons_to_prim(time, dt);
 
-      // If we detect one, return immediately.
-      if (cfl_violation) {
+          // Check for CFL violations.
+          report_courant_number();
+
+          // If we detect one, return immediately.
+          if (cfl_violation) {
+              status.success = false;
+              status.reason = "CFL violation";
+              return status;
+          }
+
+      }
+
+      construct_ctu_hydro_source(time, dt);
+
+      // With tile-local primitive variables the CFL check is done
+      // by the hydro itself, as each tile is updated.
+      if (hydro_tile_local_prim == 1 && cfl_violation) {
           status.success = false;
           status.reason = "CFL violation";
           return status;
       }
 
-      construct_ctu_hydro_source(time, dt);
       apply_source_to_state(S_new, hydro_source, dt, 0);
 
       // Check for small/negative densities.
@@ -280,6 +297,27 @@ Castro::do_advance_ctu(Real time,
 
 
 
+bool
+Castro::old_data_rewritten_by_advance(int k)
+{
+    // The old-time sources are zeroed and rebuilt by do_old_sources.
+
+    if (k == Source_Type) {
+        return apply_sources();
+    }
+
+#ifdef REACTIONS
+    // The first half of the Strang burn fills the old-time reactions
+    // data, including its ghost zones.
+
+    if (k == Reactions_Type) {
+        return time_integration_method == CornerTransportUpwind;
+    }
+#endif
+
+    return false;
+}
+
 
 
 bool
@@ -296,7 +334,16 @@ Castro::retry_advance_ctu(Real& time, Real dt, int amr_iteration, int amr_ncycle
 
     if (do_retry) {
 
-        dt_subcycle = std::min(dt, dt_subcycle) * retry_subcycle_factor;
+        // If the step failed on the CFL condition, we know the Courant
+        // number it reached, so cut the timestep to bring it back under
+        // the target CFL in one go rather than by repeated retries.
+
+        Real retry_factor = retry_subcycle_factor;
+        if (cfl_violation && max_courant > 0.0) {
+            retry_factor = std::min(retry_factor, cfl / max_courant);
+        }
+
+        dt_subcycle = std::min(dt, dt_subcycle) * retry_factor;
 
         if (verbose && ParallelDescriptor::IOProcessor()) {
             std::cout << std::endl;
@@ -305,34 +352,24 @@ Castro::retry_advance_ctu(Real& time, Real dt, int amr_iteration, int amr_ncycle
             std::cout << std::endl;
         }
 
-        // If we are doing a retry and this is the first attempt
-        // at the advance, make a copy of the state data. This will
-        // be useful to us at the end of the timestep when we need
-        // to restore the original old data.
+        // We will need the current old data at the end of the timestep,
+        // to restore it as the old data of the whole step. It is moved
+        // (not copied) into prev_state, unless prev_state already holds
+        // the old data from an earlier retry in this step.
+        //
+        // The retried advance rewrites the old-time reactions data (in the
+        // first half of the burn) and the old-time sources (which depend
+        // on dt) before it reads them, so those are moved now and replaced
+        // by fresh buffers. The rest of the old data is read by the retried
+        // advance, so it stays in place; it is moved at the next swap of
+        // the time levels, which would otherwise reuse it for the new-time
+        // data (see subcycle_advance_ctu).
 
         for (int k = 0; k < num_state_type; k++) {
 
-            // We want to store the previous state in pinned memory
-            // if we're running on a GPU. This helps us alleviate
-            // pressure on the GPU memory, at the slight cost of
-            // lower bandwidth when we are saving/restoring the state.
-            // Since we're using operator= to copy the StateData,
-            // we'll use a trick where we temporarily change the
-            // the arena used by the main state and then immediately
-            // restore it.
-
-            if (!prev_state[k]->hasOldData()) {
-
-#ifdef AMREX_USE_GPU
-                Arena* old_arena = state[k].getArena();
-                state[k].setArena(The_Pinned_Arena());
-#endif
-
-                *prev_state[k] = state[k];
-
-#ifdef AMREX_USE_GPU
-                state[k].setArena(old_arena);
-#endif
+            if (state[k].hasOldData() && !prev_state[k]->hasOldData() && old_data_rewritten_by_advance(k)) {
+                state[k].replaceOldData(*prev_state[k]);
+                state[k].allocOldData();
             }
 
         }
@@ -412,6 +449,11 @@ Castro::subcycle_advance_ctu(const Real time, const Real dt, int amr_iteration,
 
     bool do_swap = false;
 
+    // Set when a retry has been triggered and the rest of the old data
+    // from before it still has to be moved into prev_state.
+
+    bool save_old_data = false;
+
     Real last_dt_subcycle = 1.e200;
 
     while (subcycle_time < (1.0 - eps) * (time + dt)) {
@@ -474,8 +516,35 @@ Castro::subcycle_advance_ctu(const Real time, const Real dt, int amr_iteration,
 
         if (do_swap) {
 
+            // After a retry, the old data that was not already moved into
+            // prev_state at the retry is moved there now, rather than
+            // becoming the new-time data. The swap then allocates a fresh
+            // buffer for the new-time data, which we zero since it has no
+            // previous contents.
+
+            Vector<int> saved(num_state_type, 0);
+
+            if (save_old_data) {
+
+                for (int k = 0; k < num_state_type; k++) {
+                    if (state[k].hasOldData() && !prev_state[k]->hasOldData()) {
+                        state[k].replaceOldData(*prev_state[k]);
+                        saved[k] = 1;
+                    }
+                }
+
+                save_old_data = false;
+
+            }
+
             swap_state_time_levels(0.0);
 
+            for (int k = 0; k < num_state_type; k++) {
+                if (saved[k]) {
+                    state[k].newData().setVal(0.0);
+                }
+            }
+
 #ifdef GRAVITY
             if (do_grav) {
                 gravity->swapTimeLevels(level);
@@ -529,6 +598,18 @@ Castro::subcycle_advance_ctu(const Real time, const Real dt, int amr_iteration,
 
             status = do_advance_ctu(subcycle_time, dt_subcycle, amr_iteration, amr_ncycle);
 
+#ifdef REACTIONS
+            // If we cut the timestep short due to it being rejected,
+            // the new-time reactions data may not have been written;
+            // use the old-time data, so that it is still valid.
+
+            if (!status.success && time_integration_method == CornerTransportUpwind) {
+                MultiFab& R_old = get_old_data(Reactions_Type);
+                MultiFab& R_new = get_new_data(Reactions_Type);
+                MultiFab::Copy(R_new, R_old, 0, 0, R_new.nComp(), R_new.nGrow());
+            }
+#endif
+
 #ifdef SIMPLIFIED_SDC
 #ifdef REACTIONS
             if (time_integration_method == SimplifiedSpectralDeferredCorrections) {
@@ -604,6 +685,9 @@ Castro::subcycle_advance_ctu(const Real time, const Real dt, int amr_iteration,
                 lastDtRetryLimited = true;
                 lastDtFromRetry = dt_subcycle;
                 in_retry = true;
+                save_old_data = true;
+
+                PerfLog::add_retry();
 
                 continue;
             }
@@ -645,7 +729,6 @@ Castro::subcycle_advance_ctu(const Real time, const Real dt, int amr_iteration,
                 state[k].replaceOldData(*prev_state[k]);
 
             state[k].setTimeLevel(time + dt, dt, 0.0);
-            prev_state[k]->setTimeLevel(time + dt, dt_subcycle, 0.0);
 
         }
 
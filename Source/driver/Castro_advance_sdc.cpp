@@ -161,12 +161,17 @@ Castro::do_advance_sdc (Real time,
       if (sdc_order == 4) {
         cons_to_prim_fourth(time);
       } else {
-        cons_to_prim(time);
+        cons_to_prim(time, dt);
       }
 
       if (do_hydro) {
-        // Check for CFL violations.
-        check_for_cfl_violation(dt);
+        // Check for CFL violations. The second-order conversion has
+        // already found the largest Courant number.
+        if (sdc_order == 4) {
+          check_for_cfl_violation(dt);
+        } else {
+          report_courant_number();
+        }
 
         // If we detect one, return immediately.
         if (cfl_violation)
@@ -0,0 +1,527 @@
+#include <Castro_async_io.H>
+
+#include <AMReX_FArrayBox.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace amrex;
+
+namespace
+{
+    const char* output_names[AsyncWriter::NumOutputKinds] = { "plotfile", "small plotfile", "checkpoint" };
+
+    // Suffix of a data file that is not completely on disk yet.
+    const std::string partial_suffix = ".partial";
+
+    // Write n bytes at the given offset, retrying short writes.
+    void write_at (int fd, const char* buf, Long n, Long offset, const std::string& file_name)
+    {
+        while (n > 0) {
+            const ssize_t written = ::pwrite(fd, buf, n, offset);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("error writing " + file_name + ": " + std::strerror(errno));
+            }
+            buf += written;
+            offset += written;
+            n -= written;
+        }
+    }
+}
+
+AsyncWriter::AsyncWriter (Long max_staging_bytes_in)
+    :
+    max_staging_bytes(max_staging_bytes_in),
+    staged_bytes(0),
+    shutdown(false)
+{
+    for (int k = 0; k < NumOutputKinds; ++k) {
+        pending[k] = 0;
+        output_start[k] = std::chrono::steady_clock::now();
+    }
+
+    io_thread = std::thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter ()
+{
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        shutdown = true;
+    }
+    cv.notify_all();
+
+    if (io_thread.joinable()) {
+        io_thread.join();
+    }
+
+    releaseFinished();
+
+    if (!error_message.empty()) {
+        amrex::Error(error_message.c_str());
+    }
+
+    // Everything on this rank is on disk; once that holds everywhere
+    // the last outputs can get their final names.
+
+    ParallelDescriptor::Barrier("AsyncWriter::~AsyncWriter");
+
+    for (int k = 0; k < NumOutputKinds; ++k) {
+        renameFiles(static_cast<OutputKind>(k));
+    }
+}
+
+void
+AsyncWriter::run ()
+{
+    // Note: nothing in here may call MPI.
+
+    while (true) {
+
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return shutdown || !jobs.empty(); });
+
+            if (jobs.empty()) {
+                // shutdown was requested and everything has been drained
+                return;
+            }
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        std::string err;
+
+        try {
+            job.work();
+        }
+        catch (const std::exception& e) {
+            err = std::string("asynchronous ") + output_names[job.kind] + " write failed: " + e.what();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            staged_bytes -= job.bytes;
+            pending[job.kind] -= 1;
+            if (!err.empty() && error_message.empty()) {
+                error_message = err;
+            }
+
+            // The work holds the last reference to the staged data; hand
+            // it back so that it is freed on the main thread.
+
+            finished.push_back(std::move(job.work));
+        }
+        cv.notify_all();
+
+    }
+}
+
+void
+AsyncWriter::enqueue (OutputKind kind, Long bytes, std::function<void()>&& work)
+{
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        staged_bytes += bytes;
+        pending[kind] += 1;
+        jobs.push_back(Job{kind, bytes, std::move(work)});
+    }
+    cv.notify_all();
+}
+
+void
+AsyncWriter::checkForErrors ()
+{
+    std::string err;
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        err = error_message;
+    }
+
+    if (!err.empty()) {
+        amrex::Error(err.c_str());
+    }
+}
+
+void
+AsyncWriter::releaseFinished ()
+{
+    std::vector<std::function<void()>> done;
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        done.swap(finished);
+    }
+
+    // done is destroyed here, on the calling (main) thread.
+}
+
+void
+AsyncWriter::reserve (Long bytes)
+{
+    // If a single output is larger than the whole budget, the best we
+    // can do is to wait for the queue to empty out.
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this, bytes] { return staged_bytes == 0 || staged_bytes + bytes <= max_staging_bytes; });
+    }
+
+    releaseFinished();
+}
+
+void
+AsyncWriter::wait (OutputKind kind)
+{
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this, kind] { return pending[kind] == 0; });
+    }
+
+    releaseFinished();
+
+    checkForErrors();
+}
+
+void
+AsyncWriter::waitAll ()
+{
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return jobs.empty() && staged_bytes == 0; });
+    }
+
+    releaseFinished();
+
+    checkForErrors();
+}
+
+Long
+AsyncWriter::stagedBytes ()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    return staged_bytes;
+}
+
+Long
+AsyncWriter::localBytes (const BoxArray& ba,
+                         const DistributionMapping& dm,
+                         int ncomp, int ngrow)
+{
+    const int myproc = ParallelDescriptor::MyProc();
+
+    Long npts = 0;
+
+    for (int i = 0; i < ba.size(); ++i) {
+        if (dm[i] == myproc) {
+            npts += amrex::grow(ba[i], ngrow).numPts();
+        }
+    }
+
+    return npts * ncomp * static_cast<Long>(sizeof(Real));
+}
+
+void
+AsyncWriter::beginOutput (OutputKind kind)
+{
+    BL_PROFILE("AsyncWriter::beginOutput()");
+
+    // The previous output of this kind must be complete everywhere
+    // before we start writing the next one.
+
+    wait(kind);
+
+    ParallelDescriptor::Barrier("AsyncWriter::beginOutput");
+
+    renameFiles(kind);
+
+    output_start[kind] = std::chrono::steady_clock::now();
+}
+
+void
+AsyncWriter::completeOutputs ()
+{
+    BL_PROFILE("AsyncWriter::completeOutputs()");
+
+    releaseFinished();
+
+    checkForErrors();
+
+    int done[NumOutputKinds];
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        for (int k = 0; k < NumOutputKinds; ++k) {
+            done[k] = pending[k] == 0;
+        }
+    }
+
+    ParallelDescriptor::ReduceIntMin(done, NumOutputKinds);
+
+    for (int k = 0; k < NumOutputKinds; ++k) {
+        if (done[k]) {
+            renameFiles(static_cast<OutputKind>(k));
+        }
+    }
+}
+
+void
+AsyncWriter::renameFiles (OutputKind kind)
+{
+    // Only called once every rank has written and synced the data files
+    // of all outputs of this kind issued so far. The directory may have
+    // been renamed in the meantime, so we work relative to its descriptor.
+
+    if (!ParallelDescriptor::IOProcessor()) return;
+
+    for (auto it = partial_files.begin(); it != partial_files.end(); ) {
+
+        if (it->kind != kind) {
+            ++it;
+            continue;
+        }
+
+        for (const std::string& name : it->names) {
+            const std::string partial_name = name + partial_suffix;
+            if (::renameat(it->dir_fd, partial_name.c_str(), it->dir_fd, name.c_str()) != 0) {
+                amrex::Error(("AsyncWriter: could not rename " + partial_name + ": " + std::strerror(errno)).c_str());
+            }
+        }
+
+        ::fsync(it->dir_fd);
+        ::close(it->dir_fd);
+
+        it = partial_files.erase(it);
+    }
+}
+
+void
+AsyncWriter::writeMultiFab (std::shared_ptr<MultiFab> mf,
+                            const std::string& mf_name,
+                            OutputKind kind,
+                            bool single_precision)
+{
+    BL_PROFILE("AsyncWriter::writeMultiFab()");
+
+    const int ncomp = mf->nComp();
+    const Vector<int>& local_boxes = mf->IndexArray();
+
+    // We write the data either in the native format or as native 32-bit
+    // floats, so the byte count of each FAB is known in advance; this is
+    // what lets us write the header before the data exists on disk. The
+    // FAB headers are rendered here since the FABio object is global and
+    // cannot be used from the I/O thread.
+
+    const FABio::Format old_format = FArrayBox::getFormat();
+
+    if (single_precision) {
+        FArrayBox::setFormat(FABio::FAB_NATIVE_32);
+    } else {
+        AMREX_ALWAYS_ASSERT(old_format == FABio::FAB_NATIVE);
+    }
+
+    const Long bytes_per_value = single_precision ? sizeof(float) : sizeof(Real);
+
+    // Like VisMF, the ranks share nfiles data files, and each rank writes
+    // its FABs, in order, into its own contiguous part of its file. Compute
+    // the offset of each FAB within that part, and the size of the part.
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int myproc = ParallelDescriptor::MyProc();
+    const int nfiles = std::max(1, std::min(VisMF::GetNOutFiles(), nprocs));
+
+    Vector<Long> offsets(mf->size(), 0);
+
+    auto fab_headers = std::make_shared<Vector<std::string>>();
+
+    Long nbytes = 0;
+
+    for (int idx : local_boxes) {
+        const FArrayBox& fab = (*mf)[idx];
+        std::stringstream hss;
+        FArrayBox::getFABio().write_header(hss, fab, ncomp);
+        fab_headers->push_back(hss.str());
+        offsets[idx] = nbytes;
+        nbytes += static_cast<Long>(fab_headers->back().size()) + fab.box().numPts() * ncomp * bytes_per_value;
+    }
+
+    if (single_precision) {
+        FArrayBox::setFormat(old_format);
+    }
+
+    // The parts of a file are in rank order, so the start of each rank's
+    // part follows from the part sizes of all ranks. Every box is owned by
+    // exactly one rank, so a sum reduction assembles the offset list.
+
+    Vector<Long> part_start(nprocs, 0);
+    part_start[myproc] = nbytes;
+
+    ParallelDescriptor::ReduceLongSum(part_start.dataPtr(), nprocs);
+
+    Vector<Long> file_size(nfiles, 0);
+    for (int p = 0; p < nprocs; ++p) {
+        const Long part_bytes = part_start[p];
+        part_start[p] = file_size[p % nfiles];
+        file_size[p % nfiles] += part_bytes;
+    }
+
+    ParallelDescriptor::ReduceLongSum(offsets.dataPtr(), offsets.size(), ParallelDescriptor::IOProcessorNumber());
+
+    // The header constructor does the (collective) min/max calculation.
+
+    VisMF::Header hdr(*mf, VisMF::NFiles, VisMF::Header::Version_v1, true);
+
+    const std::string base_name = VisMF::BaseName(mf_name);
+
+    if (ParallelDescriptor::IOProcessor()) {
+
+        std::set<int> files_used;
+
+        for (int i = 0; i < mf->size(); ++i) {
+            const int owner = mf->DistributionMap()[i];
+            hdr.m_fod[i] = VisMF::FabOnDisk(amrex::Concatenate(base_name + "_D_", owner % nfiles, 5),
+                                            part_start[owner] + offsets[i]);
+            files_used.insert(owner % nfiles);
+        }
+
+        const std::string hdr_name = mf_name + "_H";
+        std::ofstream hdr_file(hdr_name.c_str(), std::ios::out | std::ios::trunc);
+        if (!hdr_file.good()) {
+            amrex::FileOpenFailed(hdr_name);
+        }
+        hdr_file << hdr;
+        hdr_file.close();
+
+        // Remember the data files, so that they can be given their final
+        // names once they are completely written.
+
+        const std::size_t slash = mf_name.rfind('/');
+        const std::string dir_name = slash == std::string::npos ? "." : mf_name.substr(0, slash);
+
+        DataFiles files;
+        files.kind = kind;
+        files.dir_fd = ::open(dir_name.c_str(), O_RDONLY);
+        if (files.dir_fd < 0) {
+            amrex::FileOpenFailed(dir_name);
+        }
+        for (int n : files_used) {
+            files.names.push_back(amrex::Concatenate(base_name + "_D_", n, 5));
+        }
+        partial_files.push_back(std::move(files));
+    }
+
+    if (local_boxes.empty()) {
+        return;
+    }
+
+    // The directory was cleaned when it was created, so the file does not
+    // need to be truncated, which would race with the other ranks' writes.
+
+    const std::string data_name = amrex::Concatenate(mf_name + "_D_", myproc % nfiles, 5) + partial_suffix;
+
+    const int fd = ::open(data_name.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) {
+        amrex::FileOpenFailed(data_name);
+    }
+
+    const Long start = part_start[myproc];
+
+    enqueue(kind, nbytes,
+            [mf, fd, start, fab_headers, ncomp, single_precision, data_name] ()
+            {
+                std::vector<float> buf;
+
+                const Vector<int>& boxes = mf->IndexArray();
+
+                Long offset = start;
+
+                for (int n = 0; n < boxes.size(); ++n) {
+                    const FArrayBox& fab = (*mf)[boxes[n]];
+                    const Long nvalues = fab.box().numPts() * ncomp;
+
+                    const std::string& fab_header = (*fab_headers)[n];
+                    write_at(fd, fab_header.data(), fab_header.size(), offset, data_name);
+                    offset += fab_header.size();
+
+                    if (single_precision) {
+                        const Real* dp = fab.dataPtr();
+                        buf.resize(nvalues);
+                        for (Long i = 0; i < nvalues; ++i) {
+                            buf[i] = static_cast<float>(dp[i]);
+                        }
+                        write_at(fd, reinterpret_cast<const char*>(buf.data()), nvalues * sizeof(float), offset, data_name);
+                        offset += nvalues * sizeof(float);
+                    } else {
+                        write_at(fd, reinterpret_cast<const char*>(fab.dataPtr()), nvalues * sizeof(Real), offset, data_name);
+                        offset += nvalues * sizeof(Real);
+                    }
+                }
+
+                // The file only gets its final name once this is durable.
+
+                if (::fsync(fd) != 0) {
+                    ::close(fd);
+                    throw std::runtime_error("error syncing " + data_name + ": " + std::strerror(errno));
+                }
+
+                ::close(fd);
+            });
+}
+
+void
+AsyncWriter::noteCompletion (const std::string& job_info_file,
+                             OutputKind kind)
+{
+    auto os = std::make_shared<std::ofstream>(job_info_file.c_str(), std::ios::out | std::ios::app);
+    if (!os->good()) {
+        amrex::FileOpenFailed(job_info_file);
+    }
+
+    const std::chrono::steady_clock::time_point start = output_start[kind];
+
+    enqueue(kind, 0,
+            [os, start] ()
+            {
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+                // localtime is not thread safe, so use the reentrant version.
+
+                time_t now = time(0);
+                tm localtm;
+                localtime_r(&now, &localtm);
+
+                char time_str[64];
+                strftime(time_str, sizeof(time_str), "%a %b %e %H:%M:%S %Y", &localtm);
+
+                std::string PrettyLine = std::string(78, '=') + "\n";
+
+                *os << "\n";
+                *os << PrettyLine;
+                *os << " Asynchronous Output\n";
+                *os << PrettyLine;
+                *os << "write completed:              " << time_str << "\n";
+                *os << "background I/O time (s):      " << elapsed.count() << "\n";
+                *os << "(as seen by the I/O processor; the output is complete on all\n"
+                    << " ranks once the next output of the same kind begins)\n";
+
+                os->close();
+            });
+}
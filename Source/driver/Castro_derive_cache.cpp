@@ -0,0 +1,96 @@
+#include <Castro_derive_cache.H>
+
+#include <AMReX_ParallelDescriptor.H>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace amrex;
+
+namespace
+{
+    // Times are taken from StateData, so they should match exactly; allow
+    // for roundoff anyway.
+    bool same_time (Real t1, Real t2)
+    {
+        return std::abs(t1 - t2) <= 1.e-12 * std::max(std::abs(t1), std::abs(t2));
+    }
+}
+
+bool DeriveCache::suspended = false;
+
+void
+DeriveCache::setBudget (Long bytes)
+{
+    max_bytes = bytes;
+
+    if (max_bytes <= 0) {
+        clear();
+    }
+}
+
+const MultiFab*
+DeriveCache::find (const std::string& name, Real time, int ngrow)
+{
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->name == name && it->ngrow == ngrow && same_time(it->time, time)) {
+            // Move this entry to the front of the list.
+            entries.splice(entries.begin(), entries, it);
+            ++num_hits;
+            return entries.front().mf.get();
+        }
+    }
+
+    ++num_misses;
+
+    return nullptr;
+}
+
+void
+DeriveCache::insert (const std::string& name, Real time, const MultiFab& mf)
+{
+    BL_PROFILE("DeriveCache::insert()");
+
+    Long bytes = 0;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        bytes += mf[mfi].nBytes();
+    }
+
+    // A miss leads to a collective FillPatch, so every rank must make the
+    // same hit/miss decisions. Account for the largest per-rank footprint
+    // so that eviction is identical everywhere.
+
+    ParallelDescriptor::ReduceLongMax(bytes);
+
+    // Something that does not fit even in an empty cache is not stored.
+
+    if (bytes > max_bytes) return;
+
+    // Replace any existing entry with the same key.
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->name == name && it->ngrow == mf.nGrow() && same_time(it->time, time)) {
+            used_bytes -= it->bytes;
+            entries.erase(it);
+            break;
+        }
+    }
+
+    while (used_bytes + bytes > max_bytes) {
+        used_bytes -= entries.back().bytes;
+        entries.pop_back();
+    }
+
+    std::unique_ptr<MultiFab> copy(new MultiFab(mf.boxArray(), mf.DistributionMap(), mf.nComp(), mf.nGrow()));
+    MultiFab::Copy(*copy, mf, 0, 0, mf.nComp(), mf.nGrow());
+
+    entries.push_front(Entry{name, time, mf.nGrow(), bytes, std::move(copy)});
+    used_bytes += bytes;
+}
+
+void
+DeriveCache::clear ()
+{
+    entries.clear();
+    used_bytes = 0;
+}
@@ -0,0 +1,403 @@
+#include <Castro.H>
+#include <Castro_F.H>
+#include <Castro_geometry.H>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+
+using namespace amrex;
+
+//
+// In-situ analysis output.
+//
+// Every castro.insitu_interval coarse steps (or castro.insitu_per in
+// simulation time) we write slices through the center, radial profiles
+// about the center and global reductions of the castro.insitu_vars to
+// a set of binary streaming files:
+//
+//   <insitu_file>_slice_<x|y|z>.bin
+//   <insitu_file>_profile.bin
+//   <insitu_file>_reductions.bin
+//
+// Each file starts with a header
+//
+//   char[8]   "CAINSITU"
+//   int32     format version
+//   int32     kind (0 = slice, 1 = profile, 2 = reductions)
+//   int32     number of variables, followed by each name as an int32
+//             length and the characters
+//
+// and is followed by one record per output
+//
+//   int64     number of bytes in the rest of the record
+//   int64     coarse step
+//   float64   time
+//
+// then, for a slice:    int32 normal direction, float64 position,
+//                       int32 n1, int32 n2, float64 lo1, lo2, d1, d2
+//                       and nvars x n2 x n1 float32 values (n1 fastest)
+//       for a profile:  int32 nbins, float64 dr and nvars x nbins float32
+//                       volume-weighted averages (bin i is centered at
+//                       (i + 1/2) dr)
+//       for reductions: nvars x (min, max, volume integral) float64
+//
+// All values are in the native byte order. The slices and profiles are
+// sampled at the resolution of the finest level; coarser data is
+// injected. Util/scripts/read_insitu.py reads these files.
+//
+
+namespace
+{
+    const char insitu_magic[8] = {'C','A','I','N','S','I','T','U'};
+    const std::int32_t insitu_version = 1;
+
+    enum { insitu_slice = 0, insitu_profile, insitu_reductions };
+
+    template <class T>
+    void append (Vector<char>& buf, const T& value)
+    {
+        const char* p = reinterpret_cast<const char*>(&value);
+        buf.insert(buf.end(), p, p + sizeof(T));
+    }
+
+    // Append a record to a stream file, writing the file header first
+    // if the file is new.
+    void write_record (const std::string& file_name, int kind,
+                       const Vector<std::string>& names,
+                       const Vector<char>& record)
+    {
+        std::ifstream test(file_name, std::ios::in | std::ios::binary | std::ios::ate);
+        const bool is_new = !test.good() || test.tellg() == 0;
+        test.close();
+
+        std::ofstream os(file_name, std::ios::out | std::ios::app | std::ios::binary);
+        if (!os.good()) {
+            amrex::FileOpenFailed(file_name);
+        }
+
+        if (is_new) {
+            Vector<char> hdr;
+            hdr.insert(hdr.end(), insitu_magic, insitu_magic + 8);
+            append(hdr, insitu_version);
+            append(hdr, static_cast<std::int32_t>(kind));
+            append(hdr, static_cast<std::int32_t>(names.size()));
+            for (const auto& name : names) {
+                append(hdr, static_cast<std::int32_t>(name.size()));
+                hdr.insert(hdr.end(), name.begin(), name.end());
+            }
+            os.write(hdr.dataPtr(), hdr.size());
+        }
+
+        const std::int64_t nbytes = record.size();
+        os.write(reinterpret_cast<const char*>(&nbytes), sizeof(nbytes));
+        os.write(record.dataPtr(), record.size());
+
+        if (!os.good()) {
+            amrex::Error("Castro::insitu_output: error writing " + file_name);
+        }
+    }
+}
+
+void
+Castro::insitu_output ()
+{
+    BL_PROFILE("Castro::insitu_output()");
+
+    BL_ASSERT(level == 0);
+
+    const int nvars = insitu_vars.size();
+
+    if (nvars == 0) return;
+
+    const Real strt_time = ParallelDescriptor::second();
+
+    const int finest_level = parent->finestLevel();
+    const Real time = state[State_Type].curTime();
+    const std::int64_t nstep = parent->levelSteps(0);
+
+    Real center[3];
+    ca_get_center(center);
+
+    // The slices and profiles are sampled on the finest level.
+
+    const Geometry& fgeom = parent->Geom(finest_level);
+    const Box& fdomain = fgeom.Domain();
+    const Real* fdx = fgeom.CellSize();
+    const Real* problo = fgeom.ProbLo();
+    const Real* probhi = fgeom.ProbHi();
+
+    // Slices: one for each requested normal direction, through the
+    // finest-level zone containing the center.
+
+    const int nslices = insitu_slice_normals.size();
+
+    Vector<int> slice_index(nslices), slice_dir1(nslices), slice_dir2(nslices), slice_n1(nslices), slice_n2(nslices);
+    Vector<Vector<Real>> slice_data(nslices);
+
+    for (int s = 0; s < nslices; ++s) {
+        const int normal = insitu_slice_normals[s];
+        if (normal < 0 || normal >= AMREX_SPACEDIM || AMREX_SPACEDIM == 1) {
+            amrex::Error("castro.insitu_slice_normals must be valid coordinate directions in 2-d and 3-d");
+        }
+
+        // The in-plane directions; in 2-d the slice is a line.
+        slice_dir1[s] = (normal == 0) ? 1 : 0;
+        slice_dir2[s] = (AMREX_SPACEDIM == 3) ? ((normal == 2) ? 1 : 2) : -1;
+
+        slice_n1[s] = fdomain.length(slice_dir1[s]);
+        slice_n2[s] = (slice_dir2[s] >= 0) ? fdomain.length(slice_dir2[s]) : 1;
+
+        const int idx = static_cast<int>(std::floor((center[normal] - problo[normal]) / fdx[normal]));
+        slice_index[s] = std::min(std::max(idx, fdomain.smallEnd(normal)), fdomain.bigEnd(normal));
+
+        slice_data[s].resize(nvars * slice_n1[s] * slice_n2[s], 0.0);
+    }
+
+    // Radial profiles: bins of width dx on the finest level, out to the
+    // farthest corner of the domain.
+
+    Real maxdist = 0.0;
+    for (int n = 0; n < AMREX_SPACEDIM; ++n) {
+        const Real d = std::max(std::abs(probhi[n] - center[n]), std::abs(problo[n] - center[n]));
+        maxdist += d * d;
+    }
+    maxdist = std::sqrt(maxdist);
+
+    const Real dr = fdx[0];
+    const int nbins = insitu_do_profiles ? static_cast<int>(maxdist / dr) + 1 : 0;
+
+    Vector<Real> profile_data(nvars * nbins, 0.0);
+    Vector<Real> profile_vol(nbins, 0.0);
+
+    // Reductions.
+
+    Vector<Real> var_min(nvars, std::numeric_limits<Real>::max());
+    Vector<Real> var_max(nvars, std::numeric_limits<Real>::lowest());
+    Vector<Real> var_sum(nvars, 0.0);
+
+    for (int lev = 0; lev <= finest_level; ++lev) {
+
+        Castro& ca_lev = getLevel(lev);
+
+        const Geometry& lgeom = parent->Geom(lev);
+
+        // The zone volumes are computed analytically.
+        const int coord = lgeom.Coord();
+        const auto dx_arr = lgeom.CellSizeArray();
+        const auto problo_arr = lgeom.ProbLoArray();
+
+        // Refinement factor between this level and the finest one.
+        IntVect ratio(1);
+        for (int l = lev; l < finest_level; ++l) {
+            ratio *= parent->refRatio(l);
+        }
+
+        const MultiFab* mask = (lev < finest_level) ? &getLevel(lev+1).build_fine_mask() : nullptr;
+
+        for (int v = 0; v < nvars; ++v) {
+
+            auto mf = ca_lev.derive(insitu_vars[v], time, 0);
+
+            if (!mf) {
+                amrex::Error("Castro::insitu_output: unknown variable " + insitu_vars[v]);
+            }
+
+            var_min[v] = std::min(var_min[v], mf->min(0, 0, true));
+            var_max[v] = std::max(var_max[v], mf->max(0, 0, true));
+
+            // Only the zones not covered by a finer level contribute to
+            // the integrals, slices and profiles.
+
+            if (mask) {
+                MultiFab::Multiply(*mf, *mask, 0, 0, 1, 0);
+            }
+
+            ReduceOps<ReduceOpSum> reduce_op;
+            ReduceData<Real> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            for (MFIter mfi(*mf, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                auto const& fab = (*mf).array(mfi);
+
+                const Box& box = mfi.tilebox();
+
+                reduce_op.eval(box, reduce_data,
+                [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) noexcept -> ReduceTuple
+                {
+                    return {fab(i,j,k) * cell_volume(i, j, k, coord, dx_arr, problo_arr)};
+                });
+            }
+
+            ReduceTuple hv = reduce_data.value();
+            var_sum[v] += amrex::get<0>(hv);
+
+            // The profiles use the same radial binning as the monopole
+            // gravity, with each zone split into subzones of the finest
+            // level's size. The data was multiplied by the mask above,
+            // so binning the mask gives the volume of the uncovered zones.
+
+            if (nbins > 0) {
+
+                Gpu::ManagedVector<Real> bin_sum(nbins, 0.0);
+                Gpu::ManagedVector<Real> bin_vol(nbins, 0.0);
+
+                radialSum(*mf, 0, lgeom, dr, ratio[0], lev, nbins, bin_sum.dataPtr(), bin_vol.dataPtr());
+
+                for (int b = 0; b < nbins; ++b) {
+                    profile_data[v * nbins + b] += bin_sum[b];
+                }
+
+                if (v == 0) {
+                    if (mask) {
+                        Gpu::ManagedVector<Real> mask_vol(nbins, 0.0);
+                        std::fill(bin_vol.begin(), bin_vol.end(), 0.0);
+                        radialSum(*mask, 0, lgeom, dr, ratio[0], lev, nbins, bin_vol.dataPtr(), mask_vol.dataPtr());
+                    }
+                    for (int b = 0; b < nbins; ++b) {
+                        profile_vol[b] += bin_vol[b];
+                    }
+                }
+            }
+
+            if (nslices == 0) continue;
+
+            amrex::prefetchToHost(*mf);
+
+            // This loop scatters into global arrays, so it is done on the
+            // host. Within a level no two zones write the same slice pixel.
+
+            for (int s = 0; s < nslices; ++s) {
+
+                const int normal = insitu_slice_normals[s];
+                const int d1 = slice_dir1[s];
+                const int d2 = slice_dir2[s];
+                const int n1 = slice_n1[s];
+                const int n2 = slice_n2[s];
+                const int plane = slice_index[s] / ratio[normal];
+
+                Real* slc = slice_data[s].dataPtr() + v * n1 * n2;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+                for (MFIter mfi(*mf); mfi.isValid(); ++mfi) {
+
+                    Box bx = mfi.validbox();
+
+                    if (bx.smallEnd(normal) > plane || bx.bigEnd(normal) < plane) continue;
+
+                    bx.setSmall(normal, plane);
+                    bx.setBig(normal, plane);
+
+                    const auto dat = (*mf).array(mfi);
+                    const auto lo = amrex::lbound(bx);
+                    const auto hi = amrex::ubound(bx);
+
+                    for (int k = lo.z; k <= hi.z; ++k) {
+                        for (int j = lo.y; j <= hi.y; ++j) {
+                            for (int i = lo.x; i <= hi.x; ++i) {
+                                const IntVect iv(AMREX_D_DECL(i, j, k));
+                                const int c1 = iv[d1] * ratio[d1];
+                                const int c2 = (d2 >= 0) ? iv[d2] * ratio[d2] : 0;
+                                const int r2 = (d2 >= 0) ? ratio[d2] : 1;
+                                for (int p2 = 0; p2 < r2; ++p2) {
+                                    for (int p1 = 0; p1 < ratio[d1]; ++p1) {
+                                        slc[(c2 + p2) * n1 + (c1 + p1)] += dat(i,j,k);
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+        }
+    }
+
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+
+    ParallelDescriptor::ReduceRealMin(var_min.dataPtr(), nvars, IOProc);
+    ParallelDescriptor::ReduceRealMax(var_max.dataPtr(), nvars, IOProc);
+    ParallelDescriptor::ReduceRealSum(var_sum.dataPtr(), nvars, IOProc);
+
+    for (int s = 0; s < nslices; ++s) {
+        ParallelDescriptor::ReduceRealSum(slice_data[s].dataPtr(), slice_data[s].size(), IOProc);
+    }
+
+    if (nbins > 0) {
+        ParallelDescriptor::ReduceRealSum(profile_data.dataPtr(), profile_data.size(), IOProc);
+        ParallelDescriptor::ReduceRealSum(profile_vol.dataPtr(), profile_vol.size(), IOProc);
+    }
+
+    if (ParallelDescriptor::IOProcessor()) {
+
+        const char* dir_names[3] = {"x", "y", "z"};
+
+        for (int s = 0; s < nslices; ++s) {
+
+            const int normal = insitu_slice_normals[s];
+            const int d1 = slice_dir1[s];
+            const int d2 = slice_dir2[s];
+
+            Vector<char> record;
+            append(record, nstep);
+            append(record, static_cast<double>(time));
+            append(record, static_cast<std::int32_t>(normal));
+            append(record, static_cast<double>(problo[normal] + (slice_index[s] + 0.5) * fdx[normal]));
+            append(record, static_cast<std::int32_t>(slice_n1[s]));
+            append(record, static_cast<std::int32_t>(slice_n2[s]));
+            append(record, static_cast<double>(problo[d1]));
+            append(record, static_cast<double>(d2 >= 0 ? problo[d2] : 0.0));
+            append(record, static_cast<double>(fdx[d1]));
+            append(record, static_cast<double>(d2 >= 0 ? fdx[d2] : 0.0));
+            for (const Real val : slice_data[s]) {
+                append(record, static_cast<float>(val));
+            }
+
+            write_record(insitu_file + "_slice_" + dir_names[normal] + ".bin", insitu_slice, insitu_vars, record);
+        }
+
+        if (nbins > 0) {
+
+            Vector<char> record;
+            append(record, nstep);
+            append(record, static_cast<double>(time));
+            append(record, static_cast<std::int32_t>(nbins));
+            append(record, static_cast<double>(dr));
+            for (int v = 0; v < nvars; ++v) {
+                for (int b = 0; b < nbins; ++b) {
+                    const Real avg = profile_vol[b] > 0.0 ? profile_data[v * nbins + b] / profile_vol[b] : 0.0;
+                    append(record, static_cast<float>(avg));
+                }
+            }
+
+            write_record(insitu_file + "_profile.bin", insitu_profile, insitu_vars, record);
+        }
+
+        {
+            Vector<char> record;
+            append(record, nstep);
+            append(record, static_cast<double>(time));
+            for (int v = 0; v < nvars; ++v) {
+                append(record, static_cast<double>(var_min[v]));
+                append(record, static_cast<double>(var_max[v]));
+                append(record, static_cast<double>(var_sum[v]));
+            }
+
+            write_record(insitu_file + "_reductions.bin", insitu_reductions, insitu_vars, record);
+        }
+    }
+
+    if (verbose > 0) {
+        Real run_time = ParallelDescriptor::second() - strt_time;
+        ParallelDescriptor::ReduceRealMax(run_time, IOProc);
+        amrex::Print() << "Castro::insitu_output() time = " << run_time << "\n" << "\n";
+    }
+}
@@ -3,6 +3,7 @@
 #include <unistd.h>
 #endif
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <string>
@@ -12,6 +13,9 @@
 #include "Castro.H"
 #include "Castro_F.H"
 #include "Castro_io.H"
+#include "Castro_async_io.H"
+#include "Castro_plot_compression.H"
+#include "Castro_perf_log.H"
 #include <AMReX_ParmParse.H>
 
 #ifdef RADIATION
@@ -54,6 +58,12 @@ namespace
 {
     int input_version = -1;
     int current_version = 7;
+
+    // the number of state types in the checkpoint we are restarting from
+    int checkpoint_nstate = -1;
+
+    // whether the checkpoint we are restarting from has the cost estimate
+    bool cost_in_checkpoint = true;
 }
 
 // I/O routines for Castro
@@ -138,8 +148,47 @@ Castro::restart (Amr&     papa,
 
     // also need to mod checkPoint function to store the new version in a text file
 
+    // Find out how many state types the checkpoint has. This is the
+    // level header that AmrLevel::restart reads; we read it up to the
+    // number of state types and then go back.
+
+    {
+        const auto pos = is.tellg();
+
+        int lev;
+        Geometry lev_geom;
+        BoxArray lev_grids;
+
+        is >> lev;
+        is >> lev_geom;
+        if (bReadSpecial) {
+            amrex::readBoxArray(lev_grids, is, bReadSpecial);
+        } else {
+            lev_grids.readFrom(is);
+        }
+        is >> checkpoint_nstate;
+
+        is.clear();
+        is.seekg(pos);
+    }
+
+    cost_in_checkpoint = true;
+
     AmrLevel::restart(papa,is,bReadSpecial);
 
+    if (Cost_Type >= 0 && !cost_in_checkpoint) {
+
+        // The cost estimate was not read, so it has to be defined
+        // before it can be started from zero.
+
+        state[Cost_Type].define(geom.Domain(), grids, dmap, desc_lst[Cost_Type],
+                                state[State_Type].curTime(), parent->dtLevel(level),
+                                *m_factory);
+
+        get_new_data(Cost_Type).setVal(0.0);
+
+    }
+
     buildMetrics();
 
     initMFs();
@@ -405,6 +454,25 @@ Castro::set_state_in_checkpoint (Vector<int>& state_in_checkpoint)
     for (int i=0; i<num_state_type; ++i) {
         state_in_checkpoint[i] = 1;
     }
+
+    // The cost estimate is optional, so a checkpoint may have been
+    // written without it; it is then started from zero. It is the last
+    // state type, so it is the one missing when the checkpoint has one
+    // state type fewer than we do. Any other difference is an error.
+
+    const int ndesc = desc_lst.size();
+
+    if (ndesc > checkpoint_nstate) {
+
+        if (Cost_Type < 0 || Cost_Type != ndesc - 1 || checkpoint_nstate != ndesc - 1) {
+            amrex::Error("The checkpoint has " + std::to_string(checkpoint_nstate) +
+                         " state types, but " + std::to_string(ndesc) + " are defined");
+        }
+
+        state_in_checkpoint[Cost_Type] = 0;
+        cost_in_checkpoint = false;
+
+    }
 }
 
 void
@@ -414,28 +482,58 @@ Castro::checkPoint(const std::string& dir,
                    bool dump_old_default)
 {
 
-  for (int s = 0; s < num_state_type; ++s) {
-      if (dump_old && state[s].hasOldData()) {
-          MultiFab& old_MF = get_old_data(s);
-          amrex::prefetchToHost(old_MF);
+  PerfRegion perf_region(PerfLog::IO);
+
+  Real io_time;
+
+  if (async_io) {
+
+      if (async_writer == 0) {
+          async_writer = new AsyncWriter(static_cast<Long>(async_io_max_staging_mb * 1024.0 * 1024.0));
       }
-      MultiFab& new_MF = get_new_data(s);
-      amrex::prefetchToHost(new_MF);
-  }
 
-  const Real io_start_time = ParallelDescriptor::second();
+      // Make sure the last checkpoint is completely written before
+      // we start on this one.
+
+      if (level == 0) {
+          async_writer->beginOutput(AsyncWriter::CheckPoint);
+      }
+
+      // In this case the I/O time is only the time needed to
+      // stage the data; the write itself happens in the background.
+
+      const Real io_start_time = ParallelDescriptor::second();
 
-  AmrLevel::checkPoint(dir, os, how, dump_old);
+      asyncCheckPoint(dir, os, dump_old);
 
-  const Real io_time = ParallelDescriptor::second() - io_start_time;
+      io_time = ParallelDescriptor::second() - io_start_time;
 
-  for (int s = 0; s < num_state_type; ++s) {
-      if (dump_old && state[s].hasOldData()) {
-          MultiFab& old_MF = get_old_data(s);
-          amrex::prefetchToDevice(old_MF);
+  } else {
+
+      for (int s = 0; s < num_state_type; ++s) {
+          if (dump_old && state[s].hasOldData()) {
+              MultiFab& old_MF = get_old_data(s);
+              amrex::prefetchToHost(old_MF);
+          }
+          MultiFab& new_MF = get_new_data(s);
+          amrex::prefetchToHost(new_MF);
+      }
+
+      const Real io_start_time = ParallelDescriptor::second();
+
+      AmrLevel::checkPoint(dir, os, how, dump_old);
+
+      io_time = ParallelDescriptor::second() - io_start_time;
+
+      for (int s = 0; s < num_state_type; ++s) {
+          if (dump_old && state[s].hasOldData()) {
+              MultiFab& old_MF = get_old_data(s);
+              amrex::prefetchToDevice(old_MF);
+          }
+          MultiFab& new_MF = get_new_data(s);
+          amrex::prefetchToDevice(new_MF);
       }
-      MultiFab& new_MF = get_new_data(s);
-      amrex::prefetchToDevice(new_MF);
+
   }
 
 #ifdef RADIATION
@@ -550,6 +648,100 @@ Castro::checkPoint(const std::string& dir,
         }
     }
 
+  // Once the finest level has been queued, record in the job_info
+  // file when the background write finishes.
+
+  if (async_io && level == parent->finestLevel() && ParallelDescriptor::IOProcessor()) {
+      async_writer->noteCompletion(dir + "/job_info", AsyncWriter::CheckPoint);
+  }
+
+}
+
+void
+Castro::asyncCheckPoint(const std::string& dir,
+                        std::ostream&      os,
+                        bool               dump_old)
+{
+    BL_PROFILE("Castro::asyncCheckPoint()");
+
+    // This mirrors AmrLevel::checkPoint and StateData::checkPoint, except
+    // that the state data is copied into a staging buffer and handed to
+    // the I/O thread rather than written with VisMF::Write.
+
+    std::string LevelDir, FullPath;
+    LevelDirectoryNames(dir, LevelDir, FullPath);
+
+    if (!levelDirectoryCreated) {
+        CreateLevelDirectory(dir);
+        // Force other processors to wait until directory is built.
+        ParallelDescriptor::Barrier("Castro::asyncCheckPoint::dir");
+    }
+
+    const int ndesc = desc_lst.size();
+
+    if (ParallelDescriptor::IOProcessor()) {
+        os << level << '\n' << geom << '\n';
+        grids.writeOn(os);
+        os << ndesc << '\n';
+    }
+
+    for (int i = 0; i < ndesc; ++i) {
+
+        const std::string PathNameInHdr = amrex::Concatenate(LevelDir + "/SD_", i, 1);
+        const std::string FullPathName  = amrex::Concatenate(FullPath + "/SD_", i, 1);
+
+        const std::string mf_name_new = PathNameInHdr + "_New_MF";
+        const std::string mf_name_old = PathNameInHdr + "_Old_MF";
+
+        StateData& sd = state[i];
+
+        // All of Castro's state data is defined at a point in time.
+
+        AMREX_ALWAYS_ASSERT(desc_lst[i].timeType() == StateDescriptor::Point);
+
+        const bool store = desc_lst[i].store_in_checkpoint();
+        const bool write_old = store && dump_old && sd.hasOldData();
+
+        if (ParallelDescriptor::IOProcessor()) {
+            os << sd.getDomain() << '\n';
+            sd.boxArray().writeOn(os);
+            os << '\n';
+            os << sd.curTime() << '\n'
+               << sd.curTime() << '\n';
+            os << sd.prevTime() << '\n'
+               << sd.prevTime() << '\n';
+            if (!store) {
+                os << 0 << '\n';
+            } else if (write_old) {
+                os << 2 << '\n' << mf_name_new << '\n' << mf_name_old << '\n';
+            } else {
+                os << 1 << '\n' << mf_name_new << '\n';
+            }
+        }
+
+        if (!store) continue;
+
+        for (int n = 0; n < 1 + static_cast<int>(write_old); ++n) {
+
+            const MultiFab& mf = (n == 0) ? sd.newData() : sd.oldData();
+
+            async_writer->reserve(AsyncWriter::localBytes(mf.boxArray(), mf.DistributionMap(), mf.nComp(), mf.nGrow()));
+
+            auto staged = std::make_shared<MultiFab>(mf.boxArray(), mf.DistributionMap(), mf.nComp(), mf.nGrow(),
+                                                     MFInfo().SetArena(The_Pinned_Arena()));
+
+            MultiFab::Copy(*staged, mf, 0, 0, mf.nComp(), mf.nGrow());
+
+            Gpu::Device::synchronize();
+
+            async_writer->writeMultiFab(staged, FullPathName + (n == 0 ? "_New_MF" : "_Old_MF"),
+                                        AsyncWriter::CheckPoint);
+
+        }
+
+    }
+
+    levelDirectoryCreated = false;
 }
 
 std::string
@@ -657,9 +849,27 @@ Castro::writeJobInfo (const std::string& dir, const Real io_time)
   }
 
   jobInfoFile << "I/O time (s):       " << io_time << "\n";
+  if (async_io) {
+    jobInfoFile << "I/O mode:           asynchronous (the I/O time is the staging time;\n"
+                << "                    see the end of this file for the write completion)\n";
+  }
 
   jobInfoFile << "\n\n";
 
+  if (derive_cache_max_mb > 0.0) {
+    jobInfoFile << PrettyLine;
+    jobInfoFile << " Derived Variable Cache\n";
+    jobInfoFile << PrettyLine;
+
+    for (int i = 0; i <= parent->finestLevel(); i++) {
+      const DeriveCache& cache = getLevel(i).deriveCache();
+      jobInfoFile << "level " << i << ": hits " << cache.hits()
+                  << ", misses " << cache.misses() << "\n";
+    }
+
+    jobInfoFile << "\n\n";
+  }
+
 #ifdef AMREX_USE_GPU
   // This output assumes for simplicity that every rank uses the
   // same type of GPU.
@@ -981,6 +1191,25 @@ Castro::plotFileOutput(const std::string& dir,
                        VisMF::How how,
                        const int is_small)
 {
+    PerfRegion perf_region(PerfLog::IO);
+
+    const AsyncWriter::OutputKind output_kind = is_small ? AsyncWriter::SmallPlotFile : AsyncWriter::PlotFile;
+
+    if (async_io) {
+
+        if (async_writer == 0) {
+            async_writer = new AsyncWriter(static_cast<Long>(async_io_max_staging_mb * 1024.0 * 1024.0));
+        }
+
+        // Make sure the last plotfile of this type is completely
+        // written before we start on this one.
+
+        if (level == 0) {
+            async_writer->beginOutput(output_kind);
+        }
+
+    }
+
 #ifdef AMREX_PARTICLES
   ParticlePlotFile(dir);
 #endif
@@ -995,7 +1224,8 @@ Castro::plotFileOutput(const std::string& dir,
         for (int comp = 0; comp < desc_lst[typ].nComp(); comp++)
             if (((parent->isStatePlotVar(desc_lst[typ].name(comp)) && is_small == 0) ||
                  (parent->isStateSmallPlotVar(desc_lst[typ].name(comp)) && is_small == 1)) &&
-                desc_lst[typ].getType() == IndexType::TheCellType())
+                desc_lst[typ].getType() == IndexType::TheCellType() &&
+                typ != Cost_Type) // written through the "cost" derived variable
                 plot_var_map.push_back(std::pair<int,int>(typ,comp));
 
     int num_derive = 0;
@@ -1033,46 +1263,77 @@ Castro::plotFileOutput(const std::string& dir,
 
     Real cur_time = state[State_Type].curTime();
 
-    if (level == 0 && ParallelDescriptor::IOProcessor())
-    {
-        //
-        // The first thing we write out is the plotfile type.
-        //
-        os << thePlotFileType() << '\n';
+    if (n_data_items == 0)
+        amrex::Error("Must specify at least one valid data item to plot");
 
-        if (n_data_items == 0)
-            amrex::Error("Must specify at least one valid data item to plot");
-
-        os << n_data_items << '\n';
+    //
+    // Names of variables -- first state, then derived
+    //
+    Vector<std::string> plot_names;
 
-        //
-        // Names of variables -- first state, then derived
-        //
-        for (int i =0; i < plot_var_map.size(); i++)
-        {
-            int typ = plot_var_map[i].first;
-            int comp = plot_var_map[i].second;
-            os << desc_lst[typ].name(comp) << '\n';
-        }
+    for (int i =0; i < plot_var_map.size(); i++)
+    {
+        int typ = plot_var_map[i].first;
+        int comp = plot_var_map[i].second;
+        plot_names.push_back(desc_lst[typ].name(comp));
+    }
 
-        for (auto it = derive_names.begin(); it != derive_names.end(); ++it)
-        {
-            const DeriveRec* rec = derive_lst.get(*it);
-            if (rec->numDerive() > 1) {
-                for (int i = 0; i < rec->numDerive(); ++i) {
-                    os << rec->variableName(0) + '_' + std::to_string(i) + '\n';
-                }
-            }
-            else {
-                os << rec->variableName(0) << '\n';
+    for (auto it = derive_names.begin(); it != derive_names.end(); ++it)
+    {
+        const DeriveRec* rec = derive_lst.get(*it);
+        if (rec->numDerive() > 1) {
+            for (int i = 0; i < rec->numDerive(); ++i) {
+                plot_names.push_back(rec->variableName(0) + '_' + std::to_string(i));
             }
         }
+        else {
+            plot_names.push_back(rec->variableName(0));
+        }
+    }
 
 #ifdef RADIATION
-        for (int i=0; i<Radiation::nplotvar; ++i)
-            os << Radiation::plotvar_names[i] << '\n';
+    for (int i=0; i<Radiation::nplotvar; ++i)
+        plot_names.push_back(Radiation::plotvar_names[i]);
 #endif
 
+    //
+    // Sort the variables by how they are stored.  The uncompressed
+    // variables go into the one MultiFab per level that is listed in the
+    // Header, in single precision if that was asked for, so any plotfile
+    // reader can use them.  The compressed variables are not listed in the
+    // Header; they are stored in Level_<n>/Cell_Z and need
+    // ReadCompressedMultiFab to be read.
+    //
+    Vector<int> cell_comps, compressed_comps;
+
+    for (int i = 0; i < n_data_items; ++i)
+    {
+        const std::string& name = plot_names[i];
+        if (std::find(plot_compressed_vars.begin(), plot_compressed_vars.end(), name) != plot_compressed_vars.end()) {
+            compressed_comps.push_back(i);
+        }
+        else {
+            cell_comps.push_back(i);
+        }
+    }
+
+    if (cell_comps.empty())
+        amrex::Error("At least one plot variable must not be compressed");
+
+    const bool single_precision = is_small ? small_plot_single_precision : plot_single_precision;
+
+    if (level == 0 && ParallelDescriptor::IOProcessor())
+    {
+        //
+        // The first thing we write out is the plotfile type.
+        //
+        os << thePlotFileType() << '\n';
+
+        os << cell_comps.size() << '\n';
+
+        for (int i : cell_comps)
+            os << plot_names[i] << '\n';
+
         os << BL_SPACEDIM << '\n';
         os << parent->cumTime() << '\n';
         int f_lev = parent->finestLevel();
@@ -1155,21 +1416,28 @@ Castro::plotFileOutput(const std::string& dir,
         // The name is relative to the Header file containing this name.
         // It's the name that gets written into the Header.
         //
-        if (n_data_items > 0)
-        {
-            std::string PathNameInHeader = Level;
-            PathNameInHeader += BaseName;
-            os << PathNameInHeader << '\n';
-        }
+        std::string PathNameInHeader = Level;
+        PathNameInHeader += BaseName;
+        os << PathNameInHeader << '\n';
     }
     //
     // We combine all of the multifabs -- state, derived, etc -- into one
     // multifab -- plotMF.
     // NOTE: we are assuming that each state variable has one component,
     // but a derived variable is allowed to have multiple components.
+    // In the asynchronous case, plotMF is also the staging buffer that
+    // we hand off to the I/O thread, so we put it in host memory.
     int       cnt   = 0;
     const int nGrow = 0;
-    MultiFab  plotMF(grids,dmap,n_data_items,nGrow);
+    std::shared_ptr<MultiFab> plotMF_ptr;
+    if (async_io) {
+        async_writer->reserve(AsyncWriter::localBytes(grids, dmap, n_data_items, nGrow));
+        plotMF_ptr = std::make_shared<MultiFab>(grids, dmap, n_data_items, nGrow,
+                                                MFInfo().SetArena(The_Pinned_Arena()));
+    } else {
+        plotMF_ptr = std::make_shared<MultiFab>(grids, dmap, n_data_items, nGrow);
+    }
+    MultiFab& plotMF = *plotMF_ptr;
     MultiFab* this_dat = 0;
     //
     // Cull data from state variables -- use no ghost cells.
@@ -1207,17 +1475,84 @@ Castro::plotFileOutput(const std::string& dir,
     }
 #endif
 
-    amrex::prefetchToHost(plotMF);
+    const Real io_start_time = ParallelDescriptor::second();
+
+    //
+    // Pull out the components of each storage group; if a group holds
+    // every variable we can use plotMF directly.
+    //
+    auto extract_comps = [&] (const Vector<int>& comps) -> std::shared_ptr<MultiFab>
+    {
+        if (comps.size() == n_data_items) return plotMF_ptr;
+
+        std::shared_ptr<MultiFab> mf;
+        if (async_io) {
+            mf = std::make_shared<MultiFab>(grids, dmap, comps.size(), nGrow,
+                                            MFInfo().SetArena(The_Pinned_Arena()));
+        } else {
+            mf = std::make_shared<MultiFab>(grids, dmap, comps.size(), nGrow);
+        }
+        for (int n = 0; n < comps.size(); ++n) {
+            MultiFab::Copy(*mf, plotMF, comps[n], n, 1, nGrow);
+        }
+        if (!async_io) amrex::prefetchToHost(*mf);
+        return mf;
+    };
+
+    std::shared_ptr<MultiFab> cellMF = extract_comps(cell_comps);
+    std::shared_ptr<MultiFab> compressedMF;
+
+    if (!compressed_comps.empty()) compressedMF = extract_comps(compressed_comps);
+
+    if (async_io) {
+        Gpu::Device::synchronize();
+    } else {
+        amrex::prefetchToHost(plotMF);
+    }
 
     //
     // Use the Full pathname when naming the MultiFab.
     //
-    std::string TheFullPath = FullPath;
-    TheFullPath += BaseName;
+    {
+        std::string TheFullPath = FullPath;
+        TheFullPath += BaseName;
+
+        if (async_io) {
+            async_writer->writeMultiFab(cellMF, TheFullPath, output_kind, single_precision);
+        } else if (single_precision) {
+            const FABio::Format old_format = FArrayBox::getFormat();
+            FArrayBox::setFormat(FABio::FAB_NATIVE_32);
+            VisMF::Write(*cellMF,TheFullPath,how,true);
+            FArrayBox::setFormat(old_format);
+        } else {
+            VisMF::Write(*cellMF,TheFullPath,how,true);
+        }
+    }
 
-    const Real io_start_time = ParallelDescriptor::second();
+    if (compressedMF) {
+        // The compressed data is small, so it is always written synchronously.
+
+        Vector<std::string> names;
+        Vector<Real> tol, floor;
+
+        ParmParse pp("castro");
+
+        for (int i : compressed_comps) {
+            names.push_back(plot_names[i]);
+            Real var_tol = plot_compression_tol;
+            Real var_floor = plot_compression_floor;
+            pp.query(("plot_compression_tol." + plot_names[i]).c_str(), var_tol);
+            pp.query(("plot_compression_floor." + plot_names[i]).c_str(), var_floor);
+            if (var_tol <= 1.e-15 || var_floor <= 0.0) {
+                amrex::Error("castro.plot_compression_tol." + plot_names[i] + " must be > 1.e-15 and castro.plot_compression_floor." +
+                             plot_names[i] + " must be > 0");
+            }
+            tol.push_back(var_tol);
+            floor.push_back(var_floor);
+        }
 
-    VisMF::Write(plotMF,TheFullPath,how,true);
+        WriteCompressedMultiFab(*compressedMF, names, tol, floor, FullPath + "/Cell_Z");
+    }
 
     const Real io_time = ParallelDescriptor::second() - io_start_time;
 
@@ -1225,6 +1560,10 @@ Castro::plotFileOutput(const std::string& dir,
         writeJobInfo(dir, io_time);
     }
 
+    if (async_io && level == parent->finestLevel() && ParallelDescriptor::IOProcessor()) {
+        async_writer->noteCompletion(dir + "/job_info", output_kind);
+    }
+
     if (track_grid_losses && level == 0) {
 
         // store diagnostic quantities
@@ -0,0 +1,141 @@
+#include <Castro_mf_pool.H>
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+#include <iomanip>
+#include <utility>
+
+using namespace amrex;
+
+Long MultiFabPool::max_bytes = 0;
+Long MultiFabPool::idle_bytes = 0;
+std::map<std::string, MultiFabPool::Usage> MultiFabPool::usage;
+
+namespace
+{
+    // Bytes of data held by the MultiFab on this rank.
+    Long local_bytes (const MultiFab& mf)
+    {
+        Long bytes = 0;
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            bytes += mf[mfi].nBytes();
+        }
+        return bytes;
+    }
+}
+
+void
+MultiFabPool::define (MultiFab& mf, const std::string& tag,
+                      const BoxArray& ba, const DistributionMapping& dm,
+                      int ncomp, int ngrow)
+{
+    Usage& u = usage[tag];
+
+    auto it = idle.find(tag);
+
+    if (it != idle.end()) {
+
+        MultiFab& buf = it->second;
+        const Long bytes = local_bytes(buf);
+
+        idle_bytes -= bytes;
+
+        if (buf.boxArray() == ba && buf.DistributionMap() == dm &&
+            buf.nComp() == ncomp && buf.nGrow() == ngrow) {
+
+            mf = std::move(buf);
+            idle.erase(it);
+            u.reused += 1;
+            return;
+
+        }
+
+        // The layout has changed; free the old buffer.
+
+        u.live -= bytes;
+        idle.erase(it);
+
+    }
+
+    mf.define(ba, dm, ncomp, ngrow, MFInfo().SetTag(tag));
+
+    u.allocated += 1;
+    u.live += local_bytes(mf);
+    u.peak = std::max(u.peak, u.live);
+}
+
+void
+MultiFabPool::release (MultiFab& mf, const std::string& tag)
+{
+    if (!mf.ok()) return;
+
+    Usage& u = usage[tag];
+
+    const Long bytes = local_bytes(mf);
+
+    // Only keep one idle buffer per tag, and only if it fits.
+
+    auto it = idle.find(tag);
+
+    if (it == idle.end() && idle_bytes + bytes <= max_bytes) {
+        idle_bytes += bytes;
+        idle.emplace(tag, std::move(mf));
+        mf.clear();
+    }
+    else {
+        u.live -= bytes;
+        mf.clear();
+    }
+}
+
+void
+MultiFabPool::clear ()
+{
+    for (auto& entry : idle) {
+        const Long bytes = local_bytes(entry.second);
+        idle_bytes -= bytes;
+        usage[entry.first].live -= bytes;
+    }
+
+    idle.clear();
+}
+
+void
+MultiFabPool::print_usage ()
+{
+    if (usage.empty()) return;
+
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+
+    // Every rank has the same tags, since the pools are used in the
+    // same way on all of them.
+
+    Vector<Long> live, peak;
+    for (const auto& entry : usage) {
+        live.push_back(entry.second.live);
+        peak.push_back(entry.second.peak);
+    }
+
+    ParallelDescriptor::ReduceLongMax(live.data(), live.size(), IOProc);
+    ParallelDescriptor::ReduceLongMax(peak.data(), peak.size(), IOProc);
+
+    amrex::Print() << "MultiFab buffer pool (budget " << max_bytes / (1024 * 1024)
+                   << " MB per rank; bytes are the maximum over the ranks):" << std::endl;
+    amrex::Print() << "  " << std::setw(20) << std::left << "tag" << std::right
+                   << std::setw(16) << "live bytes"
+                   << std::setw(16) << "peak bytes"
+                   << std::setw(12) << "reused"
+                   << std::setw(12) << "allocated" << std::endl;
+
+    int i = 0;
+    for (const auto& entry : usage) {
+        amrex::Print() << "  " << std::setw(20) << std::left << entry.first << std::right
+                       << std::setw(16) << live[i]
+                       << std::setw(16) << peak[i]
+                       << std::setw(12) << entry.second.reused
+                       << std::setw(12) << entry.second.allocated << std::endl;
+        ++i;
+    }
+}
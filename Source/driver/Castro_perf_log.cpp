@@ -0,0 +1,297 @@
+#include <Castro_perf_log.H>
+
+#include <AMReX_BaseFab.H>
+#include <AMReX_Gpu.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+using namespace amrex;
+
+//
+// Performance log.
+//
+// When castro.perf_log_file is set, one line is appended to that file at
+// the end of every coarse timestep. Each line is a JSON object:
+//
+//   {"step": 10, "time": 1.0e-2, "dt": 1.0e-3, "nprocs": 64,
+//    "wall_time": {"total": 2.1, "hydro": 1.2, "sources": 0.1, "gravity": 0.3,
+//                  "burn": 0.4, "radiation": 0.0, "regrid": 0.05, "io": 0.0,
+//                  "other": 0.05},
+//    "zones_advanced": [32768, 131072], "mlmg_iters": [12, 0],
+//    "burn_rhs": 1234567, "burn_jac": 2345, "retries": 0,
+//    "memory": {"fab_bytes": 1.0e9, "fab_bytes_hwm": 1.2e9, "rss_hwm_bytes": 2.0e9}}
+//
+// Everything covers the interval since the previous line, so the
+// plotfiles and checkpoints written at the end of a step, which Amr does
+// after the step is finished, show up in the io time of the next line.
+//
+// The wall times are the maximum over the ranks, "total" is the wall time
+// between lines and "other" is what is left of it. The zones advanced
+// are the zones on each level times the number of timesteps it took; the
+// extra work done by retries is not included there, but the number of
+// rejected (sub)cycles is given by "retries". The MLMG iterations are those of the Poisson
+// solves for gravity whose coarsest level is the given one. The burner
+// counts are summed over the zones and only available with the C++
+// burners. The memory use is the maximum over the ranks: the bytes
+// currently allocated in FABs, the most allocated in FABs at any point of
+// the run, and the peak resident set size of the process over the run.
+//
+
+bool PerfLog::is_enabled = false;
+std::string PerfLog::log_file;
+
+Real PerfLog::record_start = 0.0;
+Real PerfLog::wall_time[PerfLog::NumRegions];
+Vector<Long> PerfLog::zones_advanced;
+Vector<Long> PerfLog::last_mlmg_iters;
+Long PerfLog::burn_rhs = 0;
+Long PerfLog::burn_jac = 0;
+int PerfLog::retries = 0;
+
+bool PerfLog::step_ended = false;
+int PerfLog::step_nstep = 0;
+Real PerfLog::step_time = 0.0;
+Real PerfLog::step_dt = 0.0;
+int PerfLog::step_finest_level = 0;
+Vector<Long> PerfLog::step_mlmg_iters;
+
+int PerfRegion::depth = 0;
+
+namespace
+{
+    const char* region_names[PerfLog::NumRegions] = { "hydro", "sources", "gravity", "burn",
+                                                      "radiation", "regrid", "io" };
+
+    // Peak resident set size of this process, in bytes.
+    Long peak_rss ()
+    {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+#ifdef __APPLE__
+        return static_cast<Long>(usage.ru_maxrss);
+#else
+        return static_cast<Long>(usage.ru_maxrss) * 1024;
+#endif
+    }
+}
+
+void
+PerfLog::init (const std::string& file_name, bool is_restart)
+{
+    is_enabled = !file_name.empty();
+
+    if (!is_enabled) return;
+
+    log_file = file_name;
+
+    if (ParallelDescriptor::IOProcessor()) {
+        std::ofstream os(log_file, is_restart ? std::ios::app : std::ios::trunc);
+        if (!os.good()) {
+            amrex::FileOpenFailed(log_file);
+        }
+    }
+
+    last_mlmg_iters.clear();
+
+    step_ended = false;
+
+    reset();
+}
+
+void
+PerfLog::reset ()
+{
+    record_start = ParallelDescriptor::second();
+
+    for (int r = 0; r < NumRegions; ++r) {
+        wall_time[r] = 0.0;
+    }
+
+    zones_advanced.clear();
+    burn_rhs = 0;
+    burn_jac = 0;
+    retries = 0;
+}
+
+void
+PerfLog::add_time (Region region, Real seconds)
+{
+    if (!is_enabled) return;
+
+    wall_time[region] += seconds;
+}
+
+void
+PerfLog::add_zones (int lev, Long zones)
+{
+    if (!is_enabled) return;
+
+    if (zones_advanced.size() <= lev) {
+        zones_advanced.resize(lev + 1, 0);
+    }
+
+    zones_advanced[lev] += zones;
+}
+
+void
+PerfLog::add_burn_counts (Long n_rhs, Long n_jac)
+{
+    if (!is_enabled) return;
+
+    burn_rhs += n_rhs;
+    burn_jac += n_jac;
+}
+
+void
+PerfLog::add_retry ()
+{
+    if (!is_enabled) return;
+
+    retries += 1;
+}
+
+void
+PerfLog::end_step (int nstep, Real time, Real dt, int finest_level,
+                   const Vector<Long>& mlmg_iters)
+{
+    if (!is_enabled) return;
+
+    step_ended = true;
+    step_nstep = nstep;
+    step_time = time;
+    step_dt = dt;
+    step_finest_level = finest_level;
+    step_mlmg_iters = mlmg_iters;
+}
+
+void
+PerfLog::flush ()
+{
+    if (!is_enabled || !step_ended) return;
+
+    write();
+
+    step_ended = false;
+}
+
+void
+PerfLog::write ()
+{
+    const int nstep = step_nstep;
+    const Real time = step_time;
+    const Real dt = step_dt;
+    const int finest_level = step_finest_level;
+    const Vector<Long>& mlmg_iters = step_mlmg_iters;
+
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+
+    // The zone counts and retries are the same on every rank, since
+    // they come from the BoxArrays and from collective decisions.
+
+    Real times[NumRegions + 1];
+    for (int r = 0; r < NumRegions; ++r) {
+        times[r] = wall_time[r];
+    }
+    times[NumRegions] = ParallelDescriptor::second() - record_start;
+
+    ParallelDescriptor::ReduceRealMax(times, NumRegions + 1, IOProc);
+
+    Long counts[2] = {burn_rhs, burn_jac};
+    ParallelDescriptor::ReduceLongSum(counts, 2, IOProc);
+
+    Long memory[3] = {amrex::TotalBytesAllocatedInFabs(),
+                      amrex::TotalBytesAllocatedInFabsHWM(),
+                      peak_rss()};
+    ParallelDescriptor::ReduceLongMax(memory, 3, IOProc);
+
+    Vector<Long> iters(finest_level + 1, 0);
+    for (int lev = 0; lev <= finest_level && lev < mlmg_iters.size(); ++lev) {
+        const Long last = lev < last_mlmg_iters.size() ? last_mlmg_iters[lev] : 0;
+        iters[lev] = mlmg_iters[lev] - last;
+    }
+    last_mlmg_iters = mlmg_iters;
+
+    if (ParallelDescriptor::IOProcessor()) {
+
+        std::ofstream os(log_file, std::ios::app);
+        if (!os.good()) {
+            amrex::FileOpenFailed(log_file);
+        }
+
+        os << std::setprecision(std::numeric_limits<Real>::max_digits10);
+
+        os << "{\"step\": " << nstep
+           << ", \"time\": " << time
+           << ", \"dt\": " << dt
+           << ", \"nprocs\": " << ParallelDescriptor::NProcs();
+
+        Real other = times[NumRegions];
+        os << ", \"wall_time\": {\"total\": " << times[NumRegions];
+        for (int r = 0; r < NumRegions; ++r) {
+            os << ", \"" << region_names[r] << "\": " << times[r];
+            other -= times[r];
+        }
+        os << ", \"other\": " << std::max(other, 0.0_rt) << "}";
+
+        os << ", \"zones_advanced\": [";
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            os << (lev > 0 ? ", " : "") << (lev < zones_advanced.size() ? zones_advanced[lev] : 0);
+        }
+        os << "]";
+
+        os << ", \"mlmg_iters\": [";
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            os << (lev > 0 ? ", " : "") << iters[lev];
+        }
+        os << "]";
+
+        os << ", \"burn_rhs\": " << counts[0]
+           << ", \"burn_jac\": " << counts[1]
+           << ", \"retries\": " << retries;
+
+        os << ", \"memory\": {\"fab_bytes\": " << memory[0]
+           << ", \"fab_bytes_hwm\": " << memory[1]
+           << ", \"rss_hwm_bytes\": " << memory[2] << "}}\n";
+
+    }
+
+    reset();
+}
+
+PerfRegion::PerfRegion (PerfLog::Region region_in)
+    :
+    region(region_in),
+    start(0.0),
+    counted(PerfLog::enabled()),
+    active(counted && depth == 0)
+{
+    if (!counted) return;
+
+    depth += 1;
+
+    if (active) {
+        start = ParallelDescriptor::second();
+    }
+}
+
+PerfRegion::~PerfRegion ()
+{
+    if (!counted) return;
+
+    depth -= 1;
+
+    if (active) {
+        // Make sure the kernels launched in the region are included.
+        Gpu::synchronize();
+        PerfLog::add_time(region, ParallelDescriptor::second() - start);
+    }
+}
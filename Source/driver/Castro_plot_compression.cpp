@@ -0,0 +1,515 @@
+#include <Castro_plot_compression.H>
+
+#include <AMReX_NFiles.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace amrex;
+
+namespace
+{
+    const std::string header_version = "CastroCompressedMultiFab_V1";
+
+    // Number of residuals that share a Rice parameter.
+    constexpr int block_size = 64;
+
+    // Residuals whose unary part would be at least this long are
+    // escaped and stored verbatim.
+    constexpr int max_unary = 32;
+
+    // How each component of a FAB is stored.
+    enum : char { mode_compressed = 0, mode_raw = 1 };
+
+    class BitWriter
+    {
+    public:
+
+        explicit BitWriter (std::vector<unsigned char>& buf_) : buf(buf_), acc(0), nbits(0) {}
+
+        void put (std::uint64_t value, int n)
+        {
+            // n may be up to 64; we add at most 32 bits at a time so the
+            // accumulator never overflows.
+            while (n > 0) {
+                const int m = std::min(n, 32);
+                const std::uint64_t mask = (std::uint64_t(1) << m) - 1;
+                acc |= (value & mask) << nbits;
+                nbits += m;
+                value = (m < 64) ? (value >> m) : 0;
+                n -= m;
+                while (nbits >= 8) {
+                    buf.push_back(static_cast<unsigned char>(acc & 0xff));
+                    acc >>= 8;
+                    nbits -= 8;
+                }
+            }
+        }
+
+        void flush ()
+        {
+            if (nbits > 0) {
+                buf.push_back(static_cast<unsigned char>(acc & 0xff));
+                acc = 0;
+                nbits = 0;
+            }
+        }
+
+    private:
+
+        std::vector<unsigned char>& buf;
+        std::uint64_t acc;
+        int nbits;
+    };
+
+    class BitReader
+    {
+    public:
+
+        BitReader (const unsigned char* data_, Long size_) : data(data_), size(size_), pos(0), acc(0), nbits(0) {}
+
+        std::uint64_t get (int n)
+        {
+            std::uint64_t value = 0;
+            int shift = 0;
+            while (n > 0) {
+                const int m = std::min(n, 32);
+                while (nbits < m) {
+                    const std::uint64_t byte = (pos < size) ? data[pos] : 0;
+                    acc |= byte << nbits;
+                    ++pos;
+                    nbits += 8;
+                }
+                const std::uint64_t mask = (std::uint64_t(1) << m) - 1;
+                value |= (acc & mask) << shift;
+                acc >>= m;
+                nbits -= m;
+                shift += m;
+                n -= m;
+            }
+            return value;
+        }
+
+    private:
+
+        const unsigned char* data;
+        Long size;
+        Long pos;
+        std::uint64_t acc;
+        int nbits;
+    };
+
+    inline std::uint64_t zigzag (std::int64_t d)
+    {
+        return (static_cast<std::uint64_t>(d) << 1) ^ static_cast<std::uint64_t>(d >> 63);
+    }
+
+    inline std::int64_t unzigzag (std::uint64_t u)
+    {
+        return static_cast<std::int64_t>(u >> 1) ^ -static_cast<std::int64_t>(u & 1);
+    }
+
+    // Quantization step in t = asinh(v/a) that guarantees
+    // |v' - v| <= tol * (|v| + a).  With |dt| <= h/2 we have
+    // |v' - v| <= (|v| + a) x e^x for x = h/2, and x e^x <= x / (1 - x),
+    // so x = tol / (1 + tol) is sufficient.
+    inline Real quantization_step (Real tol)
+    {
+        return 2.0 * tol / (1.0 + tol);
+    }
+
+    void encode_rice (const std::vector<std::uint64_t>& u, std::vector<unsigned char>& buf)
+    {
+        BitWriter bw(buf);
+
+        const std::size_t n = u.size();
+
+        for (std::size_t start = 0; start < n; start += block_size) {
+
+            const std::size_t end = std::min(n, start + block_size);
+
+            // The optimal Rice parameter is close to log2 of the mean.
+            double mean = 0.0;
+            for (std::size_t i = start; i < end; ++i) {
+                mean += static_cast<double>(u[i]);
+            }
+            mean /= static_cast<double>(end - start);
+
+            int k = 0;
+            while (k < 62 && std::ldexp(1.0, k + 1) <= mean) {
+                ++k;
+            }
+
+            bw.put(k, 6);
+
+            for (std::size_t i = start; i < end; ++i) {
+                const std::uint64_t q = u[i] >> k;
+                if (q < static_cast<std::uint64_t>(max_unary)) {
+                    bw.put((std::uint64_t(1) << q) - 1, static_cast<int>(q));
+                    bw.put(0, 1);
+                    bw.put(u[i], k);
+                } else {
+                    bw.put((std::uint64_t(1) << max_unary) - 1, max_unary);
+                    bw.put(u[i], 64);
+                }
+            }
+        }
+
+        bw.flush();
+    }
+
+    void decode_rice (const unsigned char* data, Long size, std::vector<std::uint64_t>& u)
+    {
+        BitReader br(data, size);
+
+        const std::size_t n = u.size();
+
+        for (std::size_t start = 0; start < n; start += block_size) {
+
+            const std::size_t end = std::min(n, start + block_size);
+
+            const int k = static_cast<int>(br.get(6));
+
+            for (std::size_t i = start; i < end; ++i) {
+                int q = 0;
+                while (q < max_unary && br.get(1) == 1) {
+                    ++q;
+                }
+                if (q < max_unary) {
+                    u[i] = (static_cast<std::uint64_t>(q) << k) | br.get(k);
+                } else {
+                    u[i] = br.get(64);
+                }
+            }
+        }
+    }
+
+    template <class T>
+    void append_bytes (std::vector<unsigned char>& buf, const T& value)
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(&value);
+        buf.insert(buf.end(), p, p + sizeof(T));
+    }
+
+    // Compress one component of the valid region of a FAB onto the end of buf.
+    void compress_component (const FArrayBox& fab, const Box& bx, int comp,
+                             Real tol, Real a, std::vector<unsigned char>& buf)
+    {
+        const auto dat = fab.array();
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        bool all_finite = true;
+        for (int k = lo.z; k <= hi.z; ++k) {
+            for (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    all_finite = all_finite && std::isfinite(dat(i,j,k,comp));
+                }
+            }
+        }
+
+        if (!all_finite) {
+            // Store the values verbatim so that NaNs and Infs survive.
+            buf.push_back(mode_raw);
+            for (int k = lo.z; k <= hi.z; ++k) {
+                for (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        append_bytes(buf, dat(i,j,k,comp));
+                    }
+                }
+            }
+            return;
+        }
+
+        const Real h = quantization_step(tol);
+
+        std::vector<std::uint64_t> u;
+        u.reserve(bx.numPts());
+
+        // Predict each value from its neighbor in x; the first zone of
+        // each row is predicted from the first zone of the previous row.
+        std::int64_t row_start = 0;
+        for (int k = lo.z; k <= hi.z; ++k) {
+            for (int j = lo.y; j <= hi.y; ++j) {
+                std::int64_t prev = row_start;
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    const std::int64_t q = std::llround(std::asinh(dat(i,j,k,comp) / a) / h);
+                    u.push_back(zigzag(q - prev));
+                    if (i == lo.x) row_start = q;
+                    prev = q;
+                }
+            }
+        }
+
+        std::vector<unsigned char> bits;
+        encode_rice(u, bits);
+
+        buf.push_back(mode_compressed);
+        append_bytes(buf, static_cast<double>(a));
+        append_bytes(buf, static_cast<double>(h));
+        append_bytes(buf, static_cast<Long>(bits.size()));
+        buf.insert(buf.end(), bits.begin(), bits.end());
+    }
+
+    void decompress_component (std::istream& is, FArrayBox& fab, const Box& bx, int comp)
+    {
+        auto dat = fab.array();
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        char mode;
+        is.read(&mode, 1);
+
+        if (mode == mode_raw) {
+            for (int k = lo.z; k <= hi.z; ++k) {
+                for (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        Real v;
+                        is.read(reinterpret_cast<char*>(&v), sizeof(Real));
+                        dat(i,j,k,comp) = v;
+                    }
+                }
+            }
+            return;
+        }
+
+        if (mode != mode_compressed) {
+            amrex::Error("ReadCompressedMultiFab: corrupt data file");
+        }
+
+        double a, h;
+        Long nbytes;
+        is.read(reinterpret_cast<char*>(&a), sizeof(double));
+        is.read(reinterpret_cast<char*>(&h), sizeof(double));
+        is.read(reinterpret_cast<char*>(&nbytes), sizeof(Long));
+
+        std::vector<unsigned char> bits(nbytes);
+        is.read(reinterpret_cast<char*>(bits.data()), nbytes);
+
+        std::vector<std::uint64_t> u(bx.numPts());
+        decode_rice(bits.data(), nbytes, u);
+
+        std::size_t n = 0;
+        std::int64_t row_start = 0;
+        for (int k = lo.z; k <= hi.z; ++k) {
+            for (int j = lo.y; j <= hi.y; ++j) {
+                std::int64_t q = row_start;
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    q += unzigzag(u[n++]);
+                    if (i == lo.x) row_start = q;
+                    dat(i,j,k,comp) = a * std::sinh(static_cast<double>(q) * h);
+                }
+            }
+        }
+    }
+
+    struct CompressedHeader
+    {
+        Vector<std::string> names;
+        Vector<Real> tol;
+        Vector<Real> floor;
+        BoxArray ba;
+        Vector<std::string> files;
+        Vector<Long> offsets;
+    };
+
+    void read_header (const std::string& hdr_name, CompressedHeader& hdr)
+    {
+        Vector<char> file_char_ptr;
+        ParallelDescriptor::ReadAndBcastFile(hdr_name, file_char_ptr);
+        std::string file_char_ptr_string(file_char_ptr.dataPtr());
+        std::istringstream is(file_char_ptr_string, std::istringstream::in);
+
+        std::string version;
+        is >> version;
+        if (version != header_version) {
+            amrex::Error("ReadCompressedMultiFab: unknown header version in " + hdr_name);
+        }
+
+        int ncomp;
+        is >> ncomp;
+        hdr.names.resize(ncomp);
+        hdr.tol.resize(ncomp);
+        hdr.floor.resize(ncomp);
+        for (int n = 0; n < ncomp; ++n) {
+            is >> hdr.names[n] >> hdr.tol[n] >> hdr.floor[n];
+        }
+
+        hdr.ba.readFrom(is);
+
+        int nfabs;
+        is >> nfabs;
+        hdr.files.resize(nfabs);
+        hdr.offsets.resize(nfabs);
+        for (int i = 0; i < nfabs; ++i) {
+            is >> hdr.files[i] >> hdr.offsets[i];
+        }
+
+        if (is.fail()) {
+            amrex::Error("ReadCompressedMultiFab: unable to parse " + hdr_name);
+        }
+    }
+}
+
+void
+WriteCompressedMultiFab (const MultiFab& mf,
+                         const Vector<std::string>& names,
+                         const Vector<Real>& tol,
+                         const Vector<Real>& floor,
+                         const std::string& mf_name)
+{
+    BL_PROFILE("WriteCompressedMultiFab()");
+
+    const int ncomp = mf.nComp();
+
+    AMREX_ALWAYS_ASSERT(names.size() == ncomp && tol.size() == ncomp && floor.size() == ncomp);
+
+    // The linear-regime threshold of each component is set relative to
+    // the largest magnitude of that component.
+
+    Vector<Real> a(ncomp);
+    for (int n = 0; n < ncomp; ++n) {
+        const Real vmax = mf.norm0(n);
+        a[n] = vmax > 0.0 ? floor[n] * vmax : 1.0;
+    }
+
+    // Compress each local FAB into its own buffer.
+
+    const int nlocal = mf.local_size();
+
+    std::vector<std::vector<unsigned char>> fab_buf(nlocal);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(mf, MFItInfo().SetDynamic(true)); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        std::vector<unsigned char>& buf = fab_buf[mfi.LocalIndex()];
+        for (int n = 0; n < ncomp; ++n) {
+            compress_component(mf[mfi], bx, n, tol[n], a[n], buf);
+        }
+    }
+
+    // Like VisMF::Write, the ranks share VisMF::GetNOutFiles() data files
+    // and take turns appending their FABs to them. Every box is owned by
+    // exactly one rank, so sum reductions assemble the full lists of
+    // files and offsets.
+
+    const Vector<int>& local_boxes = mf.IndexArray();
+
+    Vector<Long> offsets(mf.size(), 0);
+    Vector<int> file_numbers(mf.size(), 0);
+
+    const int nfiles = std::max(1, std::min(ParallelDescriptor::NProcs(), VisMF::GetNOutFiles()));
+    const bool group_sets = VisMF::GetGroupSets();
+    const bool set_buf = VisMF::GetSetBuf();
+
+    for (NFilesIter nfi(nfiles, mf_name + "_D_", group_sets, set_buf); nfi.ReadyToWrite(); ++nfi) {
+
+        std::fstream& os = nfi.Stream();
+
+        for (int li = 0; li < nlocal; ++li) {
+            offsets[local_boxes[li]] = static_cast<Long>(os.tellp());
+            file_numbers[local_boxes[li]] = nfi.FileNumber();
+            os.write(reinterpret_cast<const char*>(fab_buf[li].data()), fab_buf[li].size());
+        }
+
+        if (!os.good()) {
+            amrex::Error("WriteCompressedMultiFab: error writing " + nfi.FileName());
+        }
+    }
+
+    ParallelDescriptor::ReduceLongSum(offsets.dataPtr(), offsets.size(), ParallelDescriptor::IOProcessorNumber());
+    ParallelDescriptor::ReduceIntSum(file_numbers.dataPtr(), file_numbers.size(), ParallelDescriptor::IOProcessorNumber());
+
+    const std::string base_name = VisMF::BaseName(mf_name);
+
+    if (ParallelDescriptor::IOProcessor()) {
+
+        const std::string hdr_name = mf_name + "_H";
+        std::ofstream os(hdr_name.c_str(), std::ios::out | std::ios::trunc);
+        if (!os.good()) {
+            amrex::FileOpenFailed(hdr_name);
+        }
+
+        os.precision(17);
+
+        os << header_version << '\n';
+        os << ncomp << '\n';
+        for (int n = 0; n < ncomp; ++n) {
+            os << names[n] << ' ' << tol[n] << ' ' << floor[n] << '\n';
+        }
+        mf.boxArray().writeOn(os);
+        os << '\n';
+        os << mf.size() << '\n';
+        for (int i = 0; i < mf.size(); ++i) {
+            os << amrex::Concatenate(base_name + "_D_", file_numbers[i], 5) << ' ' << offsets[i] << '\n';
+        }
+
+        if (!os.good()) {
+            amrex::Error("WriteCompressedMultiFab: error writing " + hdr_name);
+        }
+    }
+}
+
+Vector<std::string>
+CompressedMultiFabNames (const std::string& mf_name)
+{
+    const std::string hdr_name = mf_name + "_H";
+
+    if (!amrex::FileExists(hdr_name)) {
+        return Vector<std::string>();
+    }
+
+    CompressedHeader hdr;
+    read_header(hdr_name, hdr);
+
+    return hdr.names;
+}
+
+void
+ReadCompressedMultiFab (const std::string& mf_name,
+                        const DistributionMapping& dm,
+                        MultiFab& mf)
+{
+    BL_PROFILE("ReadCompressedMultiFab()");
+
+    CompressedHeader hdr;
+    read_header(mf_name + "_H", hdr);
+
+    const int ncomp = hdr.names.size();
+
+    mf.define(hdr.ba, dm, ncomp, 0);
+
+    std::string dir = mf_name;
+    const std::size_t slash = dir.rfind('/');
+    dir = (slash == std::string::npos) ? std::string() : dir.substr(0, slash + 1);
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+
+        const int i = mfi.index();
+        const std::string data_name = dir + hdr.files[i];
+
+        std::ifstream is(data_name.c_str(), std::ios::in | std::ios::binary);
+        if (!is.good()) {
+            amrex::FileOpenFailed(data_name);
+        }
+
+        is.seekg(hdr.offsets[i], std::ios::beg);
+
+        for (int n = 0; n < ncomp; ++n) {
+            decompress_component(is, mf[mfi], mfi.validbox(), n);
+        }
+
+        if (is.fail()) {
+            amrex::Error("ReadCompressedMultiFab: error reading " + data_name);
+        }
+    }
+}
@@ -703,11 +703,37 @@ Castro::variableSetUp ()
   }
 #endif
 
+  // The measured cost of the work in each zone, for finding load
+  // imbalances and for load balancing. Piecewise constant interpolation
+  // gives a new fine zone the cost of its parent zone.
+
+  if (record_cost) {
+
+    Cost_Type = desc_lst.size();
+
+    store_in_checkpoint = true;
+    desc_lst.addDescriptor(Cost_Type, IndexType::TheCellType(),
+                           StateDescriptor::Point, 0, 1,
+                           &pc_interp, state_data_extrap, store_in_checkpoint);
+
+    set_scalar_bc(bc, phys_bc);
+    desc_lst.setComponent(Cost_Type, 0, "cost_estimate", bc, genericBndryFunc);
+  }
+
   num_state_type = desc_lst.size();
 
   //
   // DEFINE DERIVED QUANTITIES
   //
+
+  //
+  // Cost estimate (seconds of work per zone in the last step)
+  //
+  if (record_cost) {
+    derive_lst.add("cost",IndexType::TheCellType(),1,ca_dercost,the_same_box);
+    derive_lst.addComponent("cost",desc_lst,Cost_Type,0,1);
+  }
+
   // Pressure
   //
   derive_lst.add("pressure",IndexType::TheCellType(),1,ca_derpres,the_same_box);
@@ -1005,6 +1005,22 @@ extern "C"
 
     }
 
+    void ca_dercost(const Box& bx, FArrayBox& derfab, int dcomp, int /*ncomp*/,
+                    const FArrayBox& datfab, const Geometry& geomdata,
+                    Real /*time*/, const int* /*bcrec*/, int /*level*/)
+    {
+
+      auto const dat = datfab.array();
+      auto const der = derfab.array();
+
+      amrex::ParallelFor(bx,
+      [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+      {
+        der(i,j,k,0) = dat(i,j,k,0);
+      });
+
+    }
+
 #ifdef __cplusplus
 }
 #endif
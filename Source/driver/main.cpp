@@ -27,6 +27,7 @@
 
 #include "Castro.H"
 #include "Castro_io.H"
+#include "Castro_perf_log.H"
 
 using namespace amrex;
 
@@ -173,6 +174,11 @@ main (int   argc,
 
     }
 
+    // Write the performance record of the last step, now that its
+    // output is done.
+
+    PerfLog::flush();
+
     // Start calculating the figure of merit for this run: average number of zones
     // advanced per microsecond. This must be done before we delete the Amr
     // object because we need to scale it by the number of zones on the coarse grid.
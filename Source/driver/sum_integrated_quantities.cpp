@@ -158,6 +158,17 @@ Castro::sum_integrated_quantities ()
 #ifdef GRAVITY
             std::cout << "TIME= " << time << " RHO*PHI     = "   << rho_phi   << '\n';
             std::cout << "TIME= " << time << " TOTAL ENERGY= "   << total_energy << '\n';
+
+            // When gravity solves may be skipped, report how many were
+            // skipped and how far the total energy has drifted over this run.
+
+            if (gravity::skip_solve_tol > 0.0) {
+                Real drift = total_energy - total_energy_start;
+                if (total_energy_start != 0.0) drift /= std::abs(total_energy_start);
+
+                std::cout << "TIME= " << time << " SKIPPED GRAVITY SOLVE FRACTION = " << gravity->get_skipped_solve_fraction() << '\n';
+                std::cout << "TIME= " << time << " RELATIVE TOTAL ENERGY DRIFT    = " << drift << '\n';
+            }
 #endif
             if (parent->NumDataLogs() > 0 ) {
 
@@ -237,3 +248,43 @@ Castro::sum_integrated_quantities ()
 #endif
     }
 }
+
+
+
+#ifdef GRAVITY
+Real
+Castro::integrated_total_energy (Real time)
+{
+    BL_PROFILE("Castro::integrated_total_energy()");
+
+    Real sums[2] = { 0.0 };
+
+    for (int lev = 0; lev <= parent->finestLevel(); lev++)
+    {
+        Castro& ca_lev = getLevel(lev);
+
+        sums[0] += ca_lev.volWgtSum("rho_E", time, true);
+        if (gravity->get_gravity_type() == "PoissonGrav")
+            sums[1] += ca_lev.volProductSum("density", "phiGrav", time, true);
+    }
+
+    ParallelDescriptor::ReduceRealSum(sums, 2);
+
+    // As in sum_integrated_quantities.
+    std::string gravity_type = gravity->get_gravity_type();
+    if (gravity_type == "PoissonGrav" || gravity_type == "MonopoleGrav")
+        return -0.5 * sums[1] + sums[0];
+    else
+        return -sums[1] + sums[0];
+}
+
+
+
+void
+Castro::set_total_energy_start ()
+{
+    if (level > 0 || verbose <= 0 || !do_grav || gravity::skip_solve_tol <= 0.0) return;
+
+    total_energy_start = integrated_total_energy(state[State_Type].curTime());
+}
+#endif
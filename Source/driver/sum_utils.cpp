@@ -1,7 +1,12 @@
 #include <iomanip>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include <Castro.H>
 #include <Castro_F.H>
+#include <Castro_geometry.H>
 
 #ifdef GRAVITY
 #include <Gravity.H>
@@ -32,13 +37,16 @@ Castro::volWgtSum (const std::string& name,
     ReduceData<Real> reduce_data(reduce_op);
     using ReduceTuple = typename decltype(reduce_data)::Type;
 
+    const int coord = geom.Coord();
+    const auto dx = geom.CellSizeArray();
+    const auto problo = geom.ProbLoArray();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif    
     for (MFIter mfi(*mf, TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
         auto const& fab = (*mf).array(mfi);
-        auto const& vol = volume.array(mfi);
 
         const Box& box = mfi.tilebox();
 
@@ -50,7 +58,7 @@ Castro::volWgtSum (const std::string& name,
         reduce_op.eval(box, reduce_data,
         [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) noexcept -> ReduceTuple
         {
-            return {fab(i,j,k) * vol(i,j,k)};
+            return {fab(i,j,k) * cell_volume(i, j, k, coord, dx, problo)};
         });
 
     }
@@ -85,13 +93,16 @@ Castro::volWgtSquaredSum (const std::string& name,
     ReduceData<Real> reduce_data(reduce_op);
     using ReduceTuple = typename decltype(reduce_data)::Type;
 
+    const int coord = geom.Coord();
+    const auto dx = geom.CellSizeArray();
+    const auto problo = geom.ProbLoArray();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif    
     for (MFIter mfi(*mf, TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
         auto const& fab = (*mf).array(mfi);
-        auto const& vol = volume.array(mfi);
     
         const Box& box = mfi.tilebox();
 
@@ -103,7 +114,7 @@ Castro::volWgtSquaredSum (const std::string& name,
         reduce_op.eval(box, reduce_data,
         [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) noexcept -> ReduceTuple
         {
-            return {fab(i,j,k) * fab(i,j,k) * vol(i,j,k)};
+            return {fab(i,j,k) * fab(i,j,k) * cell_volume(i, j, k, coord, dx, problo)};
         });
 
     }
@@ -224,6 +235,10 @@ Castro::volProductSum (const std::string& name1,
     ReduceData<Real> reduce_data(reduce_op);
     using ReduceTuple = typename decltype(reduce_data)::Type;
 
+    const int coord = geom.Coord();
+    const auto dx = geom.CellSizeArray();
+    const auto problo = geom.ProbLoArray();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif    
@@ -231,14 +246,13 @@ Castro::volProductSum (const std::string& name1,
     {
         auto const& fab1 = (*mf1).array(mfi);
         auto const& fab2 = (*mf2).array(mfi);
-        auto const& vol  = volume.array(mfi);
     
         const Box& box = mfi.tilebox();
 
         reduce_op.eval(box, reduce_data,
         [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) noexcept -> ReduceTuple
         {
-            return {fab1(i,j,k) * fab2(i,j,k) * vol(i,j,k)};
+            return {fab1(i,j,k) * fab2(i,j,k) * cell_volume(i, j, k, coord, dx, problo)};
         });
     }
 
@@ -331,3 +345,60 @@ Castro::locSquaredSum (const std::string& name,
 
     return sum;
 }
+
+void
+Castro::radialSum (const MultiFab& mf, int comp, const Geometry& geom,
+                   Real dr, int drdxfac, int lev, int n1d,
+                   Real* radial_sum, Real* radial_vol)
+{
+    BL_PROFILE("Castro::radialSum()");
+
+    const int nc = mf.nComp();
+
+    const Real* dx = geom.CellSize();
+
+#ifdef _OPENMP
+    int nthreads = omp_get_max_threads();
+    Vector< Vector<Real> > priv_radial_sum(nthreads);
+    Vector< Vector<Real> > priv_radial_vol(nthreads);
+    for (int i=0; i<nthreads; i++) {
+        priv_radial_sum[i].resize(n1d,0.0);
+        priv_radial_vol[i].resize(n1d,0.0);
+    }
+#pragma omp parallel
+#endif
+    {
+#ifdef _OPENMP
+        int tid = omp_get_thread_num();
+#endif
+        for (MFIter mfi(mf, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+
+#pragma gpu box(bx)
+            ca_compute_radial_sum(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+                                  AMREX_REAL_ANYD(dx), dr,
+                                  BL_TO_FORTRAN_ANYD(mf[mfi]), nc, comp,
+#ifdef _OPENMP
+                                  priv_radial_sum[tid].dataPtr(),
+                                  priv_radial_vol[tid].dataPtr(),
+#else
+                                  radial_sum,
+                                  radial_vol,
+#endif
+                                  AMREX_REAL_ANYD(geom.ProbLo()),
+                                  n1d, drdxfac, lev);
+        }
+
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp for
+        for (int i=0; i<n1d; i++) {
+            for (int it=0; it<nthreads; it++) {
+                radial_sum[i] += priv_radial_sum[it][i];
+                radial_vol[i] += priv_radial_vol[it][i];
+            }
+        }
+#endif
+    }
+}
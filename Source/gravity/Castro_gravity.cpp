@@ -1,5 +1,7 @@
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_cost.H"
+#include "Castro_perf_log.H"
 
 #include "Gravity.H"
 
@@ -10,6 +12,8 @@ Castro::construct_old_gravity(int amr_iteration, int amr_ncycle, Real time)
 {
     BL_PROFILE("Castro::construct_old_gravity()");
 
+    PerfRegion perf_region(PerfLog::Gravity);
+
     MultiFab& grav_old = get_old_data(Gravity_Type);
     MultiFab& phi_old = get_old_data(PhiGrav_Type);
 
@@ -31,8 +35,15 @@ Castro::construct_old_gravity(int amr_iteration, int amr_ncycle, Real time)
     // difference between the multilevel and the single level solutions.
     // Note that we don't need to do this solve for single-level runs,
     // since the solution at the end of the last timestep won't have changed.
+    // If the density has hardly changed, the old-time data (from the end of
+    // the last timestep) is kept instead, unless we need the solve for the
+    // composite correction.
+
+    const bool need_level_solve =
+        (gravity->NoComposite() != 1 && gravity->DoCompositeCorrection() && level < parent->finestLevel() && level <= gravity->get_max_solve_level()) ||
+        !gravity->skip_level_solve(level, 0);
 
-    if (gravity->get_gravity_type() == "PoissonGrav" && parent->finestLevel() > 0)
+    if (gravity->get_gravity_type() == "PoissonGrav" && parent->finestLevel() > 0 && need_level_solve)
     {
 
         // Create a copy of the current (composite) data on this level.
@@ -111,6 +122,8 @@ Castro::construct_new_gravity(int amr_iteration, int amr_ncycle, Real time)
 {
     BL_PROFILE("Castro::construct_new_gravity()");
 
+    PerfRegion perf_region(PerfLog::Gravity);
+
     MultiFab& grav_new = get_new_data(Gravity_Type);
     MultiFab& phi_new = get_new_data(PhiGrav_Type);
 
@@ -128,9 +141,33 @@ Castro::construct_new_gravity(int amr_iteration, int amr_ncycle, Real time)
 
     }
 
+    // If the density on this level has hardly changed since the last
+    // solve, reuse the old-time phi and grad phi.
+
+    bool skip_solve = false;
+
+    if (gravity->get_gravity_type() == "PoissonGrav" && level <= gravity->get_max_solve_level()) {
+        gravity->update_density_change(level);
+        skip_solve = gravity->skip_level_solve(level, 1);
+    }
+
+    if (skip_solve)
+    {
+
+        MultiFab& phi_old = get_old_data(PhiGrav_Type);
+
+        MultiFab::Copy(phi_new, phi_old, 0, 0, 1, phi_new.nGrow());
+
+        for (int n = 0; n < BL_SPACEDIM; ++n) {
+            MultiFab& gphi_new = *gravity->get_grad_phi_curr(level)[n];
+            MultiFab::Copy(gphi_new, *gravity->get_grad_phi_prev(level)[n], 0, 0, 1, gphi_new.nGrow());
+        }
+
+    }
+
     // If we're doing Poisson gravity, do the new-time level solve here.
 
-    if (gravity->get_gravity_type() == "PoissonGrav")
+    else if (gravity->get_gravity_type() == "PoissonGrav")
     {
 
         // Use the "old" phi from the current time step as a guess for this solve.
@@ -242,6 +279,8 @@ void Castro::construct_old_gravity_source(MultiFab& source, MultiFab& state_in,
     const int* domlo = geom.Domain().loVect();
     const int* domhi = geom.Domain().hiVect();
 
+    MultiFab* cost = cost_data();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -249,6 +288,8 @@ void Castro::construct_old_gravity_source(MultiFab& source, MultiFab& state_in,
     {
         const Box& bx = mfi.tilebox();
 
+        CostTimer cost_timer(cost, mfi, bx);
+
 #pragma gpu box(bx)
         ca_gsrc(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
                 AMREX_INT_ANYD(domlo), AMREX_INT_ANYD(domhi),
@@ -297,6 +338,8 @@ void Castro::construct_new_gravity_source(MultiFab& source, MultiFab& state_old,
     const int* domlo = geom.Domain().loVect();
     const int* domhi = geom.Domain().hiVect();
 
+    MultiFab* cost = cost_data();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -305,6 +348,8 @@ void Castro::construct_new_gravity_source(MultiFab& source, MultiFab& state_old,
         {
             const Box& bx = mfi.tilebox();
 
+            CostTimer cost_timer(cost, mfi, bx);
+
 #pragma gpu box(bx)
             ca_corrgsrc(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
                         AMREX_INT_ANYD(domlo), AMREX_INT_ANYD(domhi),
@@ -0,0 +1,328 @@
+#include <FFTPoisson.H>
+
+#include <AMReX_ParallelDescriptor.H>
+
+#ifdef BL_USE_MPI
+#include <fftw3-mpi.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+using namespace amrex;
+
+static_assert(std::is_same<Real, double>::value, "FFTPoisson requires double precision");
+
+namespace
+{
+    // The integral of 1/r over a unit cube centered on the origin, used
+    // for the self-cell value of the Green's function.
+    constexpr Real cube_inverse_r_integral = 2.3800772;
+}
+
+FFTPoisson::FFTPoisson (const Geometry& geom_in, bool isolated_in)
+    : geom(geom_in), isolated(isolated_in)
+{
+    BL_PROFILE("FFTPoisson::FFTPoisson()");
+
+    const Box& domain = geom.Domain();
+
+    fft_domain = domain;
+    if (isolated) {
+        fft_domain.growHi(0, domain.length(0));
+        fft_domain.growHi(1, domain.length(1));
+        fft_domain.growHi(2, domain.length(2));
+    }
+
+    n0 = fft_domain.length(2);
+    n1 = fft_domain.length(1);
+    n2 = fft_domain.length(0);
+
+    const ptrdiff_t n2c = n2 / 2 + 1;
+
+    ptrdiff_t alloc_local;
+
+#ifdef BL_USE_MPI
+    static bool fftw_mpi_initialized = false;
+    if (!fftw_mpi_initialized) {
+        fftw_mpi_init();
+        fftw_mpi_initialized = true;
+    }
+
+    MPI_Comm comm = ParallelDescriptor::Communicator();
+
+    alloc_local = fftw_mpi_local_size_3d(n0, n1, n2c, comm, &local_n0, &local_0_start);
+#else
+    local_n0 = n0;
+    local_0_start = 0;
+    alloc_local = n0 * n1 * n2c;
+#endif
+
+    // The transforms are done in place, so the real data is padded to
+    // 2 * (n2 / 2 + 1) in x.
+
+    rdata = fftw_alloc_real(2 * std::max(alloc_local, ptrdiff_t(1)));
+    cdata = reinterpret_cast<fftw_complex*>(rdata);
+
+#ifdef BL_USE_MPI
+    forward_plan  = fftw_mpi_plan_dft_r2c_3d(n0, n1, n2, rdata, cdata, comm, FFTW_ESTIMATE);
+    backward_plan = fftw_mpi_plan_dft_c2r_3d(n0, n1, n2, cdata, rdata, comm, FFTW_ESTIMATE);
+#else
+    forward_plan  = fftw_plan_dft_r2c_3d(n0, n1, n2, rdata, cdata, FFTW_ESTIMATE);
+    backward_plan = fftw_plan_dft_c2r_3d(n0, n1, n2, cdata, rdata, FFTW_ESTIMATE);
+#endif
+
+    // Build the slabs in z that match the FFTW decomposition: find out
+    // which planes every rank has, and give each rank that has any one
+    // box.
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int myproc = ParallelDescriptor::MyProc();
+
+    Vector<int> planes(2 * nprocs, 0);
+    planes[2 * myproc] = static_cast<int>(local_n0);
+    planes[2 * myproc + 1] = static_cast<int>(local_0_start);
+
+    ParallelDescriptor::ReduceIntSum(planes.dataPtr(), planes.size());
+
+    BoxList bl;
+    Vector<int> pmap;
+
+    for (int p = 0; p < nprocs; ++p) {
+        if (planes[2 * p] > 0) {
+            Box bx(fft_domain);
+            bx.setSmall(2, fft_domain.smallEnd(2) + planes[2 * p + 1]);
+            bx.setBig(2, fft_domain.smallEnd(2) + planes[2 * p + 1] + planes[2 * p] - 1);
+            bl.push_back(bx);
+            pmap.push_back(p);
+        }
+    }
+
+    BoxArray slab_ba(bl);
+    DistributionMapping slab_dm(pmap);
+
+    slab.reset(new MultiFab(slab_ba, slab_dm, 1, 0));
+
+    if (isolated) {
+        make_green_function();
+    }
+}
+
+FFTPoisson::~FFTPoisson ()
+{
+    fftw_destroy_plan(forward_plan);
+    fftw_destroy_plan(backward_plan);
+
+    fftw_free(rdata);
+
+    if (green) {
+        fftw_free(green);
+    }
+}
+
+void
+FFTPoisson::slab_to_fftw ()
+{
+    const ptrdiff_t n2p = 2 * (n2 / 2 + 1);
+
+    const IntVect lo = fft_domain.smallEnd();
+
+    Gpu::synchronize();
+
+    for (MFIter mfi(*slab); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        const auto blo = lbound(bx);
+        const auto bhi = ubound(bx);
+
+        Array4<Real const> const a = slab->const_array(mfi);
+
+        for (int k = blo.z; k <= bhi.z; ++k) {
+            const ptrdiff_t kk = k - lo[2] - local_0_start;
+            for (int j = blo.y; j <= bhi.y; ++j) {
+                const ptrdiff_t jj = j - lo[1];
+                double* row = rdata + (kk * n1 + jj) * n2p - lo[0];
+                for (int i = blo.x; i <= bhi.x; ++i) {
+                    row[i] = a(i,j,k);
+                }
+            }
+        }
+    }
+}
+
+void
+FFTPoisson::fftw_to_slab ()
+{
+    const ptrdiff_t n2p = 2 * (n2 / 2 + 1);
+
+    const IntVect lo = fft_domain.smallEnd();
+
+    for (MFIter mfi(*slab); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        const auto blo = lbound(bx);
+        const auto bhi = ubound(bx);
+
+        Array4<Real> const a = slab->array(mfi);
+
+        for (int k = blo.z; k <= bhi.z; ++k) {
+            const ptrdiff_t kk = k - lo[2] - local_0_start;
+            for (int j = blo.y; j <= bhi.y; ++j) {
+                const ptrdiff_t jj = j - lo[1];
+                const double* row = rdata + (kk * n1 + jj) * n2p - lo[0];
+                for (int i = blo.x; i <= bhi.x; ++i) {
+                    a(i,j,k) = row[i];
+                }
+            }
+        }
+    }
+}
+
+void
+FFTPoisson::make_green_function ()
+{
+    BL_PROFILE("FFTPoisson::make_green_function()");
+
+    // The free-space solution is approximated by phi_i = sum_j G(x_i - x_j) rhs_j
+    // with G = -dV / (4 pi r), the Green's function of the continuous
+    // Laplacian. On the doubled domain the convolution is periodic, so the
+    // distance is measured to the nearest image. In the self cell, 1/r is
+    // replaced by its average over the cell.
+
+    const Real* dx = geom.CellSize();
+
+    const Real dV = dx[0] * dx[1] * dx[2];
+    const Real h = std::cbrt(dV);
+
+    const Real green_self = -cube_inverse_r_integral * h * h / (4.0 * M_PI);
+
+    const ptrdiff_t n2p = 2 * (n2 / 2 + 1);
+
+    for (ptrdiff_t k = 0; k < local_n0; ++k) {
+        const ptrdiff_t kg = local_0_start + k;
+        const Real z = std::min(kg, n0 - kg) * dx[2];
+        for (ptrdiff_t j = 0; j < n1; ++j) {
+            const Real y = std::min(j, n1 - j) * dx[1];
+            for (ptrdiff_t i = 0; i < n2; ++i) {
+                const Real x = std::min(i, n2 - i) * dx[0];
+                const Real r = std::sqrt(x * x + y * y + z * z);
+                rdata[(k * n1 + j) * n2p + i] = (r > 0.0) ? -dV / (4.0 * M_PI * r) : green_self;
+            }
+        }
+    }
+
+    fftw_execute(forward_plan);
+
+    // Store the transform with the normalization of the backward
+    // transform folded in.
+
+    const ptrdiff_t ncomplex = local_n0 * n1 * (n2 / 2 + 1);
+    const Real norm = 1.0 / (static_cast<Real>(n0) * static_cast<Real>(n1) * static_cast<Real>(n2));
+
+    green = fftw_alloc_complex(std::max(ncomplex, ptrdiff_t(1)));
+
+    for (ptrdiff_t m = 0; m < ncomplex; ++m) {
+        green[m][0] = cdata[m][0] * norm;
+        green[m][1] = cdata[m][1] * norm;
+    }
+}
+
+void
+FFTPoisson::solve (MultiFab& phi, const MultiFab& rhs,
+                   const std::array<MultiFab*, AMREX_SPACEDIM>& grad_phi)
+{
+    BL_PROFILE("FFTPoisson::solve()");
+
+    // Move the RHS to the slabs. With isolated boundaries everything
+    // outside the physical domain is zero.
+
+    slab->setVal(0.0);
+    slab->ParallelCopy(rhs, 0, 0, 1);
+
+    slab_to_fftw();
+
+    fftw_execute(forward_plan);
+
+    const ptrdiff_t n2c = n2 / 2 + 1;
+
+    if (isolated) {
+
+        const ptrdiff_t ncomplex = local_n0 * n1 * n2c;
+
+        for (ptrdiff_t m = 0; m < ncomplex; ++m) {
+            const Real re = cdata[m][0] * green[m][0] - cdata[m][1] * green[m][1];
+            const Real im = cdata[m][0] * green[m][1] + cdata[m][1] * green[m][0];
+            cdata[m][0] = re;
+            cdata[m][1] = im;
+        }
+
+    } else {
+
+        // Divide by the eigenvalues of the 7-point Laplacian. The mean
+        // of the RHS must vanish on a periodic domain, so the k = 0 mode
+        // is dropped.
+
+        const Real* dx = geom.CellSize();
+        const Real norm = 1.0 / (static_cast<Real>(n0) * static_cast<Real>(n1) * static_cast<Real>(n2));
+
+        for (ptrdiff_t k = 0; k < local_n0; ++k) {
+            const ptrdiff_t kg = local_0_start + k;
+            const Real lz = (2.0 * std::cos(2.0 * M_PI * kg / n0) - 2.0) / (dx[2] * dx[2]);
+            for (ptrdiff_t j = 0; j < n1; ++j) {
+                const Real ly = (2.0 * std::cos(2.0 * M_PI * j / n1) - 2.0) / (dx[1] * dx[1]);
+                for (ptrdiff_t i = 0; i < n2c; ++i) {
+                    const Real lx = (2.0 * std::cos(2.0 * M_PI * i / n2) - 2.0) / (dx[0] * dx[0]);
+                    const ptrdiff_t m = (k * n1 + j) * n2c + i;
+                    const Real fac = (kg == 0 && j == 0 && i == 0) ? 0.0 : norm / (lx + ly + lz);
+                    cdata[m][0] *= fac;
+                    cdata[m][1] *= fac;
+                }
+            }
+        }
+
+    }
+
+    fftw_execute(backward_plan);
+
+    fftw_to_slab();
+
+    // Copy phi back, including the ghost cells. On the doubled domain the
+    // ghost cells below the physical domain are found at the top of the
+    // doubled domain.
+
+    const Periodicity period = isolated ? Periodicity(fft_domain.size()) : geom.periodicity();
+
+    phi.ParallelCopy(*slab, 0, 0, 1, 0, phi.nGrow(), period);
+
+    // The gradient on faces is the difference of phi across each face.
+    // On the physical boundary this uses the ghost cells found above:
+    // the periodic images, or with isolated boundaries the convolution
+    // itself, rather than the one-sided stencil that MLMG uses with the
+    // multipole Dirichlet values.
+
+    const Real* dx = geom.CellSize();
+
+    for (int n = 0; n < AMREX_SPACEDIM; ++n) {
+
+        const IntVect shift = IntVect::TheDimensionVector(n);
+        const int di = shift[0];
+        const int dj = shift[1];
+        const int dk = shift[2];
+        const Real dxinv = 1.0 / dx[n];
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(*grad_phi[n], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.tilebox();
+
+            Array4<Real> const g = grad_phi[n]->array(mfi);
+            Array4<Real const> const p = phi.const_array(mfi);
+
+            AMREX_PARALLEL_FOR_3D(bx, i, j, k,
+            {
+                g(i,j,k) = (p(i,j,k) - p(i-di,j-dj,k-dk)) * dxinv;
+            });
+        }
+
+    }
+}
@@ -21,6 +21,10 @@
 
 #include "MGutils.H"
 
+#if defined(FFTW) && (AMREX_SPACEDIM == 3)
+#include "FFTPoisson.H"
+#endif
+
 using namespace amrex;
 
 #ifdef AMREX_DEBUG
@@ -54,6 +58,15 @@ Gravity::Gravity(Amr* Parent, int _finest_level, BCRec* _phys_bc, int _Density)
     abs_tol(MAX_LEV),
     rel_tol(MAX_LEV),
     level_solver_resnorm(MAX_LEV),
+    phi_history(MAX_LEV),
+    phi_history_time(MAX_LEV),
+    mlmg_iters_last(MAX_LEV, 0),
+    mlmg_iters_total(MAX_LEV, 0),
+    mlmg_num_solves(MAX_LEV, 0),
+    density_change(MAX_LEV, 0.0),
+    num_skipped_in_row(MAX_LEV, 0),
+    num_skipped_solves(MAX_LEV, 0),
+    num_new_solves(MAX_LEV, 0),
     volume(MAX_LEV),
     area(MAX_LEV),
     phys_bc(_phys_bc)
@@ -75,9 +88,24 @@ Gravity::Gravity(Amr* Parent, int _finest_level, BCRec* _phys_bc, int _Density)
      if (gravity::gravity_type == "PoissonGrav") init_multipole_grav();
 #endif
      max_rhs = 0.0;
+     last_mlmg_iters = 0;
 }
 
-Gravity::~Gravity() {}
+Gravity::~Gravity()
+{
+    if (gravity::verbose && gravity::gravity_type == "PoissonGrav") {
+        for (int lev = 0; lev < MAX_LEV; ++lev) {
+            if (mlmg_num_solves[lev] > 0) {
+                amrex::Print() << "Gravity: " << mlmg_num_solves[lev] << " Poisson solves from level " << lev
+                               << ", mean MLMG iterations per solve = " << get_mean_mlmg_iters(lev) << std::endl;
+            }
+        }
+        if (gravity::skip_solve_tol > 0.0) {
+            amrex::Print() << "Gravity: fraction of new-time level solves skipped = "
+                           << get_skipped_solve_fraction() << std::endl;
+        }
+    }
+}
 
 void
 Gravity::read_params ()
@@ -246,6 +274,34 @@ Gravity::read_params ()
 
         if (pp.contains("sl_tol"))
             amrex::Warning("The gravity parameter sl_tol is no longer used.");
+
+        if (gravity::warm_start < 0 || gravity::warm_start > 2)
+            amrex::Error("gravity.warm_start must be 0, 1 or 2");
+
+        if (gravity::warm_start_max_tol_scale < 1.0)
+            amrex::Error("gravity.warm_start_max_tol_scale must be at least 1");
+
+        if (gravity::skip_solve_tol > 0.0 && gravity::skip_solve_max_interval < 1)
+            amrex::Error("gravity.skip_solve_max_interval must be at least 1");
+
+        if (gravity::fft_solver == 1) {
+#if !defined(FFTW) || (AMREX_SPACEDIM != 3)
+            amrex::Error("gravity.fft_solver = 1 requires a 3-d build with USE_FFTW = TRUE");
+#endif
+            if (!dgeom.IsCartesian())
+                amrex::Error("gravity.fft_solver = 1 requires Cartesian coordinates");
+
+            if (dgeom.isAnyPeriodic() && !dgeom.isAllPeriodic())
+                amrex::Error("gravity.fft_solver = 1 requires all periodic or all non-periodic boundaries");
+
+            // The FFT solution is not the solution of the MLMG operator, so
+            // it cannot be combined with the fine level solves, the sync
+            // solves or the composite correction.
+
+            if (parent->maxLevel() > 0)
+                amrex::Error("gravity.fft_solver = 1 is only supported for single-level runs (amr.max_level = 0)");
+        }
+
         Ggravity = 4.0 * M_PI * C::Gconst;
         if (gravity::verbose > 1 && ParallelDescriptor::IOProcessor())
         {
@@ -287,6 +343,17 @@ Gravity::install_level (int                   level,
 
     level_solver_resnorm[level] = 0.0;
 
+    // The grids may have changed, so the old solutions can no longer be
+    // used to extrapolate.
+
+    phi_history[level].clear();
+    phi_history_time[level].clear();
+
+    // Likewise, force a solve on this level at the next opportunity.
+
+    density_change[level] = std::numeric_limits<Real>::max();
+    num_skipped_in_row[level] = 0;
+
     const Geometry& geom = level_data->Geom();
 
     if (gravity::gravity_type == "PoissonGrav") {
@@ -371,6 +438,120 @@ int Gravity::test_results_of_solves()
   return test_solves;
 }
 
+int Gravity::get_mlmg_iters(int level) const
+{
+  return mlmg_iters_last[level];
+}
+
+Long Gravity::get_total_mlmg_iters(int level) const
+{
+  return mlmg_iters_total[level];
+}
+
+Real Gravity::get_mean_mlmg_iters(int level) const
+{
+  if (mlmg_num_solves[level] == 0) return 0.0;
+
+  return static_cast<Real>(mlmg_iters_total[level]) / static_cast<Real>(mlmg_num_solves[level]);
+}
+
+Real Gravity::get_skipped_solve_fraction() const
+{
+  Long skipped = 0;
+  Long total = 0;
+
+  for (int lev = 0; lev < MAX_LEV; ++lev) {
+      skipped += num_skipped_solves[lev];
+      total += num_new_solves[lev];
+  }
+
+  if (total == 0) return 0.0;
+
+  return static_cast<Real>(skipped) / static_cast<Real>(total);
+}
+
+void
+Gravity::update_density_change (int level)
+{
+    BL_PROFILE("Gravity::update_density_change()");
+
+    if (gravity::skip_solve_tol <= 0.0) return;
+
+    if (density_change[level] == std::numeric_limits<Real>::max()) return;
+
+    const MultiFab& S_old = LevelData[level]->get_old_data(State_Type);
+    const MultiFab& S_new = LevelData[level]->get_new_data(State_Type);
+
+    const int dens = Density;
+
+    // One pass over the density for the largest change and the largest
+    // value, with a single reduction.
+
+    ReduceOps<ReduceOpMax, ReduceOpMax> reduce_op;
+    ReduceData<Real, Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(S_new, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+
+        auto rho_old = S_old.array(mfi, dens);
+        auto rho_new = S_new.array(mfi, dens);
+
+        reduce_op.eval(bx, reduce_data,
+        [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) noexcept -> ReduceTuple
+        {
+            return {std::abs(rho_new(i,j,k) - rho_old(i,j,k)), rho_new(i,j,k)};
+        });
+    }
+
+    ReduceTuple hv = reduce_data.value();
+
+    Real data[2] = {amrex::get<0>(hv), amrex::get<1>(hv)};
+
+    ParallelDescriptor::ReduceRealMax(data, 2);
+
+    if (data[1] > 0.0) {
+        density_change[level] += data[0] / data[1];
+    }
+}
+
+bool
+Gravity::skip_level_solve (int level, int is_new)
+{
+    if (gravity::skip_solve_tol <= 0.0) return false;
+
+    // The change is summed over the steps since the last solve, which
+    // bounds the change relative to the density at that solve.
+
+    const bool skip = density_change[level] < gravity::skip_solve_tol &&
+                      num_skipped_in_row[level] < gravity::skip_solve_max_interval;
+
+    if (is_new == 1) {
+
+        num_new_solves[level] += 1;
+
+        if (skip) {
+            num_skipped_in_row[level] += 1;
+            num_skipped_solves[level] += 1;
+        } else {
+            density_change[level] = 0.0;
+            num_skipped_in_row[level] = 0;
+        }
+
+        if (gravity::verbose > 1) {
+            amrex::Print() << " ... " << (skip ? "skipping" : "doing")
+                           << " the new-time level Poisson solve at level " << level << std::endl;
+        }
+
+    }
+
+    return skip;
+}
+
 Vector<std::unique_ptr<MultiFab> >&
 Gravity::get_grad_phi_prev(int level)
 {
@@ -448,12 +629,30 @@ Gravity::solve_for_phi (int               level,
 
         Vector<MultiFab*> res_null;
 
-        level_solver_resnorm[level] = solve_phi_with_mlmg(level, level,
-                                                          phi_p,
-                                                          amrex::GetVecOfPtrs(rhs),
-                                                          grad_phi_p,
-                                                          res_null,
-                                                          time);
+        if (use_fft_solver(level, level)) {
+
+            level_solver_resnorm[level] = solve_phi_with_fft(phi, *rhs[0], grad_phi_p[0], time);
+
+        } else {
+
+            Real tol_scale = 1.0;
+
+            if (is_new == 1) {
+                tol_scale = warm_start_guess(level, phi, time);
+            }
+
+            level_solver_resnorm[level] = solve_phi_with_mlmg(level, level,
+                                                              phi_p,
+                                                              amrex::GetVecOfPtrs(rhs),
+                                                              grad_phi_p,
+                                                              res_null,
+                                                              time, tol_scale);
+
+            if (is_new == 1 && gravity::warm_start > 0) {
+                save_phi_history(level, phi, time);
+            }
+
+        }
 
     }
     else {
@@ -466,13 +665,15 @@ Gravity::solve_for_phi (int               level,
     {
         const int IOProc = ParallelDescriptor::IOProcessorNumber();
         Real      end    = ParallelDescriptor::second() - strt;
+        const int iters  = mlmg_iters_last[level];
 
 #ifdef BL_LAZY
         Lazy::QueueReduction( [=] () mutable {
 #endif
         ParallelDescriptor::ReduceRealMax(end,IOProc);
         if (ParallelDescriptor::IOProcessor())
-            std::cout << "Gravity::solve_for_phi() time = " << end << std::endl << std::endl;
+            std::cout << "Gravity::solve_for_phi() time = " << end
+                      << ", MLMG iterations = " << iters << std::endl << std::endl;
 #ifdef BL_LAZY
         });
 #endif
@@ -770,9 +971,13 @@ Gravity::actual_multilevel_solve (int crse_level, int finest_level_in,
     if (fine_level >= crse_level) {
 
         Vector<MultiFab*> res_null;
-        solve_phi_with_mlmg(crse_level, fine_level,
-                            phi_p, amrex::GetVecOfPtrs(rhs), grad_phi_p, res_null,
-                            time);
+        if (use_fft_solver(crse_level, fine_level)) {
+            solve_phi_with_fft(*phi_p[0], *rhs[0], grad_phi_p[0], time);
+        } else {
+            solve_phi_with_mlmg(crse_level, fine_level,
+                                phi_p, amrex::GetVecOfPtrs(rhs), grad_phi_p, res_null,
+                                time);
+        }
 
         // Average phi from fine to coarse level
         for (int amr_lev = fine_level; amr_lev > crse_level; amr_lev--)
@@ -1378,50 +1583,8 @@ Gravity::make_radial_phi(int level, const MultiFab& Rhs, MultiFab& phi, int fill
     // Define total mass in each shell
     // Note that RHS = density (we have not yet multiplied by G)
 
-#ifdef _OPENMP
-    int nthreads = omp_get_max_threads();
-    Vector< RealVector > priv_radial_mass(nthreads);
-    Vector< RealVector > priv_radial_vol (nthreads);
-    for (int i=0; i<nthreads; i++) {
-        priv_radial_mass[i].resize(n1d,0.0);
-        priv_radial_vol [i].resize(n1d,0.0);
-    }
-#pragma omp parallel
-#endif
-    {
-#ifdef _OPENMP
-        int tid = omp_get_thread_num();
-#endif
-        for (MFIter mfi(Rhs, TilingIfNotGPU()); mfi.isValid(); ++mfi)
-        {
-            const Box& bx = mfi.tilebox();
-
-#pragma gpu box(bx)
-            ca_compute_radial_mass(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
-                                   AMREX_REAL_ANYD(dx), dr,
-                                   BL_TO_FORTRAN_ANYD(Rhs[mfi]),
-#ifdef _OPENMP
-                                   priv_radial_mass[tid].dataPtr(),
-                                   priv_radial_vol[tid].dataPtr(),
-#else
-                                   radial_mass.dataPtr(),
-                                   radial_vol.dataPtr(),
-#endif
-                                   AMREX_REAL_ANYD(geom.ProbLo()),
-                                   n1d, gravity::drdxfac, level);
-        }
-
-#ifdef _OPENMP
-#pragma omp barrier
-#pragma omp for
-        for (int i=0; i<n1d; i++) {
-            for (int it=0; it<nthreads; it++) {
-                radial_mass[i] += priv_radial_mass[it][i];
-                radial_vol [i] += priv_radial_vol [it][i];
-            }
-        }
-#endif
-    }
+    Castro::radialSum(Rhs, 0, geom, dr, gravity::drdxfac, level, n1d,
+                      radial_mass.dataPtr(), radial_vol.dataPtr());
 
     ParallelDescriptor::ReduceRealSum(radial_mass.dataPtr(),n1d);
 
@@ -2310,19 +2473,15 @@ Gravity::make_radial_gravity(int level, Real time, RealVector& radial_grav)
         const Real* dx   = geom.CellSize();
         Real dr = dx[0] / static_cast<Real>(gravity::drdxfac);
 
+        Castro::radialSum(S, URHO, geom, dr, gravity::drdxfac, lev, n1d,
+                          radial_mass[lev].dataPtr(), radial_vol[lev].dataPtr());
+
+#ifdef GR_GRAV
 #ifdef _OPENMP
         int nthreads = omp_get_max_threads();
-#ifdef GR_GRAV
         Vector< RealVector > priv_radial_pres(nthreads);
-#endif
-        Vector< RealVector > priv_radial_mass(nthreads);
-        Vector< RealVector > priv_radial_vol (nthreads);
         for (int i=0; i<nthreads; i++) {
-#ifdef GR_GRAV
             priv_radial_pres[i].resize(n1d,0.0);
-#endif
-            priv_radial_mass[i].resize(n1d,0.0);
-            priv_radial_vol [i].resize(n1d,0.0);
         }
 #pragma omp parallel
 #endif
@@ -2335,21 +2494,6 @@ Gravity::make_radial_gravity(int level, Real time, RealVector& radial_grav)
                 const Box& bx = mfi.tilebox();
                 FArrayBox& fab = S[mfi];
 
-#pragma gpu box(bx)
-                ca_compute_radial_mass(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
-                                       AMREX_REAL_ANYD(dx), dr,
-                                       BL_TO_FORTRAN_ANYD(fab),
-#ifdef _OPENMP
-                                       priv_radial_mass[tid].dataPtr(),
-                                       priv_radial_vol[tid].dataPtr(),
-#else
-                                       radial_mass[lev].dataPtr(),
-                                       radial_vol[lev].dataPtr(),
-#endif
-                                       AMREX_REAL_ANYD(geom.ProbLo()),
-                                       n1d, gravity::drdxfac, lev);
-
-#ifdef GR_GRAV
                 ca_compute_avgpres(bx.loVect(), bx.hiVect(), dx, &dr,
                                    BL_TO_FORTRAN(fab),
 #ifdef _OPENMP
@@ -2358,7 +2502,6 @@ Gravity::make_radial_gravity(int level, Real time, RealVector& radial_grav)
                                    radial_pres[lev].dataPtr(),
 #endif
                                    geom.ProbLo(),&n1d,&gravity::drdxfac,&lev);
-#endif
             }
 
 #ifdef _OPENMP
@@ -2366,15 +2509,12 @@ Gravity::make_radial_gravity(int level, Real time, RealVector& radial_grav)
 #pragma omp for
             for (int i=0; i<n1d; i++) {
                 for (int it=0; it<nthreads; it++) {
-#ifdef GR_GRAV
                     radial_pres[lev][i] += priv_radial_pres[it][i];
-#endif
-                    radial_mass[lev][i] += priv_radial_mass[it][i];
-                    radial_vol [lev][i] += priv_radial_vol [it][i];
                 }
             }
 #endif
         }
+#endif
 
         ParallelDescriptor::ReduceRealSum(radial_mass[lev].dataPtr() ,n1d);
         ParallelDescriptor::ReduceRealSum(radial_vol[lev].dataPtr()  ,n1d);
@@ -2632,7 +2772,7 @@ Gravity::solve_phi_with_mlmg (int crse_level, int fine_level,
                               const Vector<MultiFab*>& rhs,
                               const Vector<Vector<MultiFab*> >& grad_phi,
                               const Vector<MultiFab*>& res,
-                              Real time)
+                              Real time, Real tol_scale)
 {
     BL_PROFILE("Gravity::solve_phi_with_mlmg()");
 
@@ -2693,14 +2833,229 @@ Gravity::solve_phi_with_mlmg (int crse_level, int fine_level,
 
     Real abs_eps = abs_tol[fine_level] * max_rhs;
 
+    rel_eps *= tol_scale;
+    abs_eps *= tol_scale;
+
     Vector<const MultiFab*> crhs{rhs.begin(), rhs.end()};
     Vector<std::array<MultiFab*,AMREX_SPACEDIM> > gp;
     for (const auto& x : grad_phi) {
         gp.push_back({AMREX_D_DECL(x[0],x[1],x[2])});
     }
 
-    return actual_solve_with_mlmg(crse_level, fine_level, phi, crhs, gp, res,
-                                  crse_bcdata, rel_eps, abs_eps);
+    Real final_resnorm = actual_solve_with_mlmg(crse_level, fine_level, phi, crhs, gp, res,
+                                                crse_bcdata, rel_eps, abs_eps);
+
+    if (!grad_phi.empty()) {
+        mlmg_iters_last[crse_level] = last_mlmg_iters;
+        mlmg_iters_total[crse_level] += last_mlmg_iters;
+        mlmg_num_solves[crse_level] += 1;
+    }
+
+    return final_resnorm;
+}
+
+bool
+Gravity::use_fft_solver (int crse_level, int fine_level) const
+{
+    return gravity::fft_solver == 1 && parent->maxLevel() == 0 &&
+           crse_level == 0 && fine_level == 0;
+}
+
+Real
+Gravity::solve_phi_with_fft (MultiFab& phi, MultiFab& rhs,
+                             const Vector<MultiFab*>& grad_phi,
+                             Real time)
+{
+    BL_PROFILE("Gravity::solve_phi_with_fft()");
+
+#if defined(FFTW) && (AMREX_SPACEDIM == 3)
+    const Geometry& geom = parent->Geom(0);
+
+    const bool isolated = !geom.isAllPeriodic();
+
+    if (!fft_poisson) {
+
+        if (isolated) {
+            for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+                if (phys_bc->lo(dir) == Symmetry || phys_bc->hi(dir) == Symmetry)
+                    amrex::Error("gravity.fft_solver = 1 does not support symmetry boundaries");
+            }
+        }
+
+        fft_poisson.reset(new FFTPoisson(geom, isolated));
+
+    }
+
+    // For the comparison, keep what MLMG would start from.
+
+    MultiFab phi_mlmg, rhs_mlmg;
+    Vector<std::unique_ptr<MultiFab> > grad_phi_mlmg(AMREX_SPACEDIM);
+
+    if (gravity::fft_compare == 1) {
+        phi_mlmg.define(phi.boxArray(), phi.DistributionMap(), 1, phi.nGrow());
+        MultiFab::Copy(phi_mlmg, phi, 0, 0, 1, phi.nGrow());
+
+        rhs_mlmg.define(rhs.boxArray(), rhs.DistributionMap(), 1, 0);
+        MultiFab::Copy(rhs_mlmg, rhs, 0, 0, 1, 0);
+
+        for (int n = 0; n < AMREX_SPACEDIM; ++n)
+            grad_phi_mlmg[n].reset(new MultiFab(grad_phi[n]->boxArray(), grad_phi[n]->DistributionMap(), 1, grad_phi[n]->nGrow()));
+    }
+
+    Real strt = ParallelDescriptor::second();
+
+    rhs.mult(Ggravity);
+
+    fft_poisson->solve(phi, rhs, {AMREX_D_DECL(grad_phi[0], grad_phi[1], grad_phi[2])});
+
+    Real fft_time = ParallelDescriptor::second() - strt;
+
+    if (gravity::fft_compare == 1) {
+
+        strt = ParallelDescriptor::second();
+
+        Vector<MultiFab*> res_null;
+        Vector<Vector<MultiFab*> > gp(1, amrex::GetVecOfPtrs(grad_phi_mlmg));
+
+        solve_phi_with_mlmg(0, 0, {&phi_mlmg}, {&rhs_mlmg}, gp, res_null, time);
+
+        Real mlmg_time = ParallelDescriptor::second() - strt;
+
+        // With periodic boundaries phi is only defined up to a constant.
+
+        Real phi_norm = phi.norm0();
+
+        if (!isolated) {
+            const Real npts = static_cast<Real>(geom.Domain().numPts());
+            phi_mlmg.plus(phi.sum() / npts - phi_mlmg.sum() / npts, 0, 1, 0);
+        }
+
+        MultiFab::Subtract(phi_mlmg, phi, 0, 0, 1, 0);
+
+        Real diff = phi_mlmg.norm0();
+
+        if (phi_norm > 0.0) diff /= phi_norm;
+
+        ParallelDescriptor::ReduceRealMax(fft_time);
+        ParallelDescriptor::ReduceRealMax(mlmg_time);
+
+        amrex::Print() << "Gravity FFT / MLMG comparison: FFT time = " << fft_time
+                       << " s, MLMG time = " << mlmg_time
+                       << " s (" << mlmg_iters_last[0] << " iterations), max relative difference in phi = "
+                       << diff << std::endl;
+
+    }
+
+    // The FFT solve has no iteration tolerance; report the tolerance
+    // MLMG would have been given.
+
+    return abs_tol[0] * max_rhs;
+#else
+    amrex::ignore_unused(phi, rhs, grad_phi, time);
+    amrex::Error("Gravity::solve_phi_with_fft requires a 3-d build with USE_FFTW = TRUE");
+    return 0.0;
+#endif
+}
+
+Real
+Gravity::warm_start_guess (int level, MultiFab& phi, Real time)
+{
+    BL_PROFILE("Gravity::warm_start_guess()");
+
+    auto& hist = phi_history[level];
+    auto& hist_time = phi_history_time[level];
+
+    // Drop anything at or after this time, which happens when a
+    // timestep is retried or a level is solved again at the same time.
+
+    while (!hist_time.empty() && hist_time.back() >= time) {
+        hist.pop_back();
+        hist_time.pop_back();
+    }
+
+    if (gravity::warm_start == 0 || hist.size() < 2) {
+        return 1.0;
+    }
+
+    const int npts = std::min(gravity::warm_start + 1, static_cast<int>(hist.size()));
+    const int first = hist.size() - npts;
+
+    // Lagrange extrapolation through the last npts solutions.
+
+    MultiFab phi_last(phi.boxArray(), phi.DistributionMap(), 1, 0);
+    MultiFab::Copy(phi_last, *hist.back(), 0, 0, 1, 0);
+
+    phi.setVal(0.0);
+
+    for (int i = first; i < first + npts; ++i) {
+        Real w = 1.0;
+        for (int j = first; j < first + npts; ++j) {
+            if (j != i) {
+                w *= (time - hist_time[j]) / (hist_time[i] - hist_time[j]);
+            }
+        }
+        MultiFab::Saxpy(phi, w, *hist[i], 0, 0, 1, phi.nGrow());
+    }
+
+    if (gravity::verbose > 1) {
+        amrex::Print() << " ... extrapolating the guess for phi at level " << level
+                       << " from " << npts << " previous solves" << std::endl;
+    }
+
+    if (gravity::warm_start_tol_factor <= 0.0) {
+        return 1.0;
+    }
+
+    // The solve does not need to be much more accurate than the change
+    // in phi over the step, so loosen the tolerance towards a fraction
+    // of the predicted relative change.
+
+    const Real phi_norm = phi_last.norm0();
+
+    MultiFab::Subtract(phi_last, phi, 0, 0, 1, 0);
+
+    const Real dphi_norm = phi_last.norm0();
+
+    // rel_tol is zero by default, in which case abs_tol (which is
+    // relative to max_rhs) sets the accuracy of the solve.
+
+    const Real base_tol = rel_tol[level] > 0.0 ? rel_tol[level] : abs_tol[level];
+
+    if (phi_norm <= 0.0 || base_tol <= 0.0) {
+        return 1.0;
+    }
+
+    const Real tol_scale = gravity::warm_start_tol_factor * (dphi_norm / phi_norm) / base_tol;
+
+    return amrex::min(gravity::warm_start_max_tol_scale, amrex::max(1.0_rt, tol_scale));
+}
+
+void
+Gravity::save_phi_history (int level, const MultiFab& phi, Real time)
+{
+    BL_PROFILE("Gravity::save_phi_history()");
+
+    auto& hist = phi_history[level];
+    auto& hist_time = phi_history_time[level];
+
+    const int max_hist = gravity::warm_start + 1;
+
+    std::unique_ptr<MultiFab> phi_save;
+
+    // Recycle the storage of the oldest solution if we have enough.
+
+    if (static_cast<int>(hist.size()) >= max_hist) {
+        phi_save = std::move(hist.front());
+        hist.erase(hist.begin());
+        hist_time.erase(hist_time.begin());
+    } else {
+        phi_save.reset(new MultiFab(phi.boxArray(), phi.DistributionMap(), 1, phi.nGrow()));
+    }
+
+    MultiFab::Copy(*phi_save, phi, 0, 0, 1, phi.nGrow());
+
+    hist.push_back(std::move(phi_save));
+    hist_time.push_back(time);
 }
 
 void
@@ -2794,6 +3149,8 @@ Gravity::actual_solve_with_mlmg (int crse_level, int fine_level,
         mlmg.setNSolve(gravity::mlmg_nsolve);
         final_resnorm = mlmg.solve(phi, rhs, rel_eps, abs_eps);
 
+        last_mlmg_iters = mlmg.getNumIters();
+
         mlmg.getGradSolution(grad_phi);
     }
     else if (!res.empty())
@@ -1,6 +1,7 @@
 #include "Castro.H"
 #include "Castro_F.H"
 #include "Castro_util.H"
+#include "Castro_geometry.H"
 #include "Castro_hydro_F.H"
 
 #ifdef RADIATION
@@ -9,90 +10,151 @@
 
 using namespace amrex;
 
+template <int coord>
 void
-Castro::consup_hydro(const Box& bx,
-                     Array4<Real const> const shk,
-                     Array4<Real> const update,
-                     Array4<Real> const flux0,
-                     Array4<Real const> const qx,
-                     Array4<Real const> const area0,
+Castro::actual_consup_hydro(const Box& bx,
+                            Array4<Real const> const shk,
+                            Array4<Real> const update,
+                            Array4<Real> const flux0,
+                            Array4<Real const> const qx,
 #if AMREX_SPACEDIM >= 2
-                     Array4<Real> const flux1,
-                     Array4<Real const> const qy,
-                     Array4<Real const> const area1,
+                            Array4<Real> const flux1,
+                            Array4<Real const> const qy,
 #endif
 #if AMREX_SPACEDIM == 3
-                     Array4<Real> const flux2,
-                     Array4<Real const> const qz,
-                     Array4<Real const> const area2,
+                            Array4<Real> const flux2,
+                            Array4<Real const> const qz,
 #endif
-                     Array4<Real const> const vol,
-                     const Real dt)
+                            const Real dt)
 {
 
 
   const auto dx = geom.CellSizeArray();
+  const auto problo = geom.ProbLoArray();
 
   // For hydro, we will create an update source term that is
   // essentially the flux divergence.  This can be added with dt to
   // get the update
 
-  int coord = geom.Coord();
+  // The face areas and zone volumes are computed from the zone index
+  // rather than read from the stored metric MultiFabs. On a Cartesian
+  // grid they are constants.
 
-  GpuArray<Real, 3> center;
-  ca_get_center(center.begin());
+  using metrics = GeometryMetrics<coord>;
+
+  // The flux divergence is the same for every component, so keep that
+  // loop free of branches and add the terms that only apply to some
+  // components in separate loops.
 
   AMREX_PARALLEL_FOR_4D(bx, NUM_STATE, i, j, k, n,
   {
 
-    Real volinv = 1.0 / vol(i,j,k);
+    Real volinv = 1.0 / metrics::volume(i, j, k, dx, problo);
 
     update(i,j,k,n) = update(i,j,k,n) +
-      ( flux0(i,j,k,n) * area0(i,j,k) - flux0(i+1,j,k,n) * area0(i+1,j,k)
+      ( flux0(i,j,k,n) * metrics::area(0, i, j, k, dx, problo) - flux0(i+1,j,k,n) * metrics::area(0, i+1, j, k, dx, problo)
 #if AMREX_SPACEDIM >= 2
-      + flux1(i,j,k,n) * area1(i,j,k) - flux1(i,j+1,k,n) * area1(i,j+1,k)
+      + flux1(i,j,k,n) * metrics::area(1, i, j, k, dx, problo) - flux1(i,j+1,k,n) * metrics::area(1, i, j+1, k, dx, problo)
 #endif
 #if AMREX_SPACEDIM == 3
-      + flux2(i,j,k,n) * area2(i,j,k) - flux2(i,j,k+1,n) * area2(i,j,k+1)
+      + flux2(i,j,k,n) * metrics::area(2, i, j, k, dx, problo) - flux2(i,j,k+1,n) * metrics::area(2, i, j, k+1, dx, problo)
 #endif
         ) * volinv;
+  });
 
-   // Add the p div(u) source term to (rho e).
-    if (n == UEINT) {
+  AMREX_PARALLEL_FOR_3D(bx, i, j, k,
+  {
+
+    Real volinv = 1.0 / metrics::volume(i, j, k, dx, problo);
+
+    // Add the p div(u) source term to (rho e).
 
-      Real pdu = (qx(i+1,j,k,GDPRES) + qx(i,j,k,GDPRES)) *
-                 (qx(i+1,j,k,GDU) * area0(i+1,j,k) - qx(i,j,k,GDU) * area0(i,j,k));
+    Real pdu = (qx(i+1,j,k,GDPRES) + qx(i,j,k,GDPRES)) *
+               (qx(i+1,j,k,GDU) * metrics::area(0, i+1, j, k, dx, problo) - qx(i,j,k,GDU) * metrics::area(0, i, j, k, dx, problo));
 
 #if AMREX_SPACEDIM >= 2
-      pdu += (qy(i,j+1,k,GDPRES) + qy(i,j,k,GDPRES)) *
-             (qy(i,j+1,k,GDV) * area1(i,j+1,k) - qy(i,j,k,GDV) * area1(i,j,k));
+    pdu += (qy(i,j+1,k,GDPRES) + qy(i,j,k,GDPRES)) *
+           (qy(i,j+1,k,GDV) * metrics::area(1, i, j+1, k, dx, problo) - qy(i,j,k,GDV) * metrics::area(1, i, j, k, dx, problo));
 #endif
 
 #if AMREX_SPACEDIM == 3
-      pdu += (qz(i,j,k+1,GDPRES) + qz(i,j,k,GDPRES)) *
-             (qz(i,j,k+1,GDW) * area2(i,j,k+1) - qz(i,j,k,GDW) * area2(i,j,k));
+    pdu += (qz(i,j,k+1,GDPRES) + qz(i,j,k,GDPRES)) *
+           (qz(i,j,k+1,GDW) * metrics::area(2, i, j, k+1, dx, problo) - qz(i,j,k,GDW) * metrics::area(2, i, j, k, dx, problo));
 #endif
 
-      pdu = 0.5 * pdu * volinv;
+    pdu = 0.5 * pdu * volinv;
 
-      update(i,j,k,n) = update(i,j,k,n) - pdu;
+    update(i,j,k,UEINT) = update(i,j,k,UEINT) - pdu;
 
 #ifdef SHOCK_VAR
-    } else if (n == USHK) {
-      update(i,j,k,USHK) = shk(i,j,k) / dt;
+    update(i,j,k,USHK) = shk(i,j,k) / dt;
 #endif
+  });
 
 #ifndef RADIATION
-    } else if (n == UMX) {
-      // Add gradp term to momentum equation -- only for axisymmetric
-      // coords (and only for the radial flux).
+  // Add gradp term to momentum equation -- only for axisymmetric
+  // coords (and only for the radial flux).
 
-      if (!mom_flux_has_p(0, 0, coord)) {
-        update(i,j,k,UMX) += - (qx(i+1,j,k,GDPRES) - qx(i,j,k,GDPRES)) / dx[0];
-      }
+  if (!mom_flux_has_p(0, 0, coord)) {
+
+    AMREX_PARALLEL_FOR_3D(bx, i, j, k,
+    {
+      update(i,j,k,UMX) += - (qx(i+1,j,k,GDPRES) - qx(i,j,k,GDPRES)) / dx[0];
+    });
+
+  }
 #endif
-    }
-  });
+}
+
+
+
+void
+Castro::consup_hydro(const Box& bx,
+                     Array4<Real const> const shk,
+                     Array4<Real> const update,
+                     Array4<Real> const flux0,
+                     Array4<Real const> const qx,
+#if AMREX_SPACEDIM >= 2
+                     Array4<Real> const flux1,
+                     Array4<Real const> const qy,
+#endif
+#if AMREX_SPACEDIM == 3
+                     Array4<Real> const flux2,
+                     Array4<Real const> const qz,
+#endif
+                     const Real dt)
+{
+
+  using kernel_t = decltype(&Castro::actual_consup_hydro<0>);
+
+#if AMREX_SPACEDIM == 3
+  const kernel_t kernel = &Castro::actual_consup_hydro<CoordSys::cartesian>;
+#elif AMREX_SPACEDIM == 2
+  static const kernel_t kernels[2] = {
+    &Castro::actual_consup_hydro<CoordSys::cartesian>,
+    &Castro::actual_consup_hydro<CoordSys::RZ>
+  };
+
+  const kernel_t kernel = kernels[geom.Coord()];
+#else
+  static const kernel_t kernels[3] = {
+    &Castro::actual_consup_hydro<CoordSys::cartesian>,
+    &Castro::actual_consup_hydro<CoordSys::RZ>,
+    &Castro::actual_consup_hydro<CoordSys::SPHERICAL>
+  };
+
+  const kernel_t kernel = kernels[geom.Coord()];
+#endif
+
+  (this->*kernel)(bx, shk, update,
+                  flux0, qx,
+#if AMREX_SPACEDIM >= 2
+                  flux1, qy,
+#endif
+#if AMREX_SPACEDIM == 3
+                  flux2, qz,
+#endif
+                  dt);
 }
 
 
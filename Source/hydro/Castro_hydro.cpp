@@ -1,6 +1,8 @@
 #include "Castro.H"
 #include "Castro_F.H"
 #include "Castro_hydro_F.H"
+#include "Castro_cost.H"
+#include "Castro_perf_log.H"
 
 #ifdef RADIATION
 #include "Radiation.H"
@@ -9,10 +11,12 @@
 using namespace amrex;
 
 void
-Castro::cons_to_prim(const Real time)
+Castro::cons_to_prim(const Real time, const Real dt)
 {
 
     BL_PROFILE("Castro::cons_to_prim()");
+
+    PerfRegion perf_region(PerfLog::Hydro);
     
 #ifdef RADIATION
     AmrLevel::FillPatch(*this, Erborder, NUM_GROW, time, Rad_Type, 0, Radiation::nGroups);
@@ -28,13 +32,34 @@ Castro::cons_to_prim(const Real time)
 
     MultiFab& S_new = get_new_data(State_Type);
 
+    // While the primitive variables are at hand, find the largest
+    // Courant number and where it is.
+
+    GpuArray<Real, 3> dtdx = {0.0_rt};
+    for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+        dtdx[i] = dt / geom.CellSize(i);
+    }
+
+    const Box domain = geom.Domain();
+
+    int ltime_integration_method = time_integration_method;
+
+    ReduceOps<ReduceOpMax, ReduceOpMax> reduce_op;
+    ReduceData<Real, Long> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+    MultiFab* cost = cost_data();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
     for (MFIter mfi(S_new, hydro_tile_size); mfi.isValid(); ++mfi) {
 
+        const Box& bx = mfi.tilebox();
         const Box& qbx = mfi.growntilebox(NUM_GROW);
 
+        CostTimer cost_timer(cost, mfi, bx);
+
         Array4<Real> const q_arr = q.array(mfi);
         Array4<Real> const qaux_arr = qaux.array(mfi);
         Array4<Real> const Sborder_arr = Sborder.array(mfi);
@@ -56,8 +81,19 @@ Castro::cons_to_prim(const Real time)
                 q_arr,
                 qaux_arr);
 
+        reduce_op.eval(bx, reduce_data,
+        [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) noexcept -> ReduceTuple
+        {
+            Real courno = courant_number(i, j, k, q_arr, qaux_arr, dtdx, ltime_integration_method);
+            return {courno, courant_key(courno, i, j, k, domain)};
+        });
+
     }
 
+    ReduceTuple hv = reduce_data.value();
+    max_courant = amrex::get<0>(hv);
+    max_courant_key = amrex::get<1>(hv);
+
 }
 
 // Convert a MultiFab with conservative state data u to a primitive MultiFab q.
@@ -242,14 +278,19 @@ Castro::check_for_cfl_violation(const Real dt)
 
     BL_PROFILE("Castro::check_for_cfl_violation()");
 
-    auto dx = geom.CellSizeArray();
+    GpuArray<Real, 3> dtdx = {0.0_rt};
+    for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+        dtdx[i] = dt / geom.CellSize(i);
+    }
+
+    const Box domain = geom.Domain();
 
     MultiFab& S_new = get_new_data(State_Type);
 
     int ltime_integration_method = time_integration_method;
 
-    ReduceOps<ReduceOpMax> reduce_op;
-    ReduceData<Real> reduce_data(reduce_op);
+    ReduceOps<ReduceOpMax, ReduceOpMax> reduce_op;
+    ReduceData<Real, Long> reduce_data(reduce_op);
     using ReduceTuple = typename decltype(reduce_data)::Type;
 
 #ifdef _OPENMP
@@ -265,107 +306,48 @@ Castro::check_for_cfl_violation(const Real dt)
         reduce_op.eval(bx, reduce_data,
         [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) noexcept -> ReduceTuple
         {
-            // Compute running max of Courant number over grids
+            Real courno = courant_number(i, j, k, q_arr, qaux_arr, dtdx, ltime_integration_method);
+            return {courno, courant_key(courno, i, j, k, domain)};
+        });
 
-            Real dtdx = dt / dx[0];
+    }
 
-            Real dtdy = 0.0_rt;
-            if (AMREX_SPACEDIM >= 2) {
-                dtdy = dt / dx[1];
-            }
+    ReduceTuple hv = reduce_data.value();
+    max_courant = amrex::get<0>(hv);
+    max_courant_key = amrex::get<1>(hv);
 
-            Real dtdz = 0.0_rt;
-            if (AMREX_SPACEDIM == 3) {
-                dtdz = dt / dx[2];
-            }
+}
 
-            Real courx = (qaux_arr(i,j,k,QC) + std::abs(q_arr(i,j,k,QU))) * dtdx;
-            Real coury = (qaux_arr(i,j,k,QC) + std::abs(q_arr(i,j,k,QV))) * dtdy;
-            Real courz = (qaux_arr(i,j,k,QC) + std::abs(q_arr(i,j,k,QW))) * dtdz;
+void
+Castro::report_courant_number()
+{
 
-            if (ltime_integration_method == 0) {
+    BL_PROFILE("Castro::report_courant_number()");
 
-                // CTU integration constraint
+    // The value and the key are both maxima, so they can be reduced
+    // separately; the key carries the location of the largest value.
 
-                return {amrex::max(courx, coury, courz)};
+    ParallelDescriptor::ReduceRealMax(max_courant);
+    ParallelDescriptor::ReduceLongMax(max_courant_key);
 
-#ifndef AMREX_USE_CUDA
-                if (verbose == 1) {
-
-                    if (courx > 1.0_rt) {
-                        std::cout << std::endl;
-                        std::cout << "Warning:: CFL violation in check_for_cfl_violation" << std::endl;
-                        std::cout << ">>> ... (u+c) * dt / dx > 1 " << courx << std::endl;
-                        std::cout << ">>> ... at cell i = " << i << " j = " << j << " k = " << k << std::endl;
-                        std::cout << ">>> ... u = " << q_arr(i,j,k,QU) << " c = " << qaux_arr(i,j,k,QC) << std::endl;
-                        std::cout << ">>> ... density = " << q_arr(i,j,k,QRHO) << std::endl;
-                    }
-
-                    if (coury > 1.0_rt) {
-                        std::cout << std::endl;
-                        std::cout << "Warning:: CFL violation in check_for_cfl_violation" << std::endl;
-                        std::cout << ">>> ... (v+c) * dt / dx > 1 " << coury << std::endl;
-                        std::cout << ">>> ... at cell i = " << i << " j = " << j << " k = " << k << std::endl;
-                        std::cout << ">>> ... v = " << q_arr(i,j,k,QV) << " c = " << qaux_arr(i,j,k,QC) << std::endl;
-                        std::cout << ">>> ... density = " << q_arr(i,j,k,QRHO) << std::endl;
-                    }
-
-                    if (courz > 1.0_rt) {
-                        std::cout << std::endl;
-                        std::cout << "Warning:: CFL violation in check_for_cfl_violation" << std::endl;
-                        std::cout << ">>> ... (w+c) * dt / dx > 1 " << courz << std::endl;
-                        std::cout << ">>> ... at cell i = " << i << " j = " << j << " k = " << k << std::endl;
-                        std::cout << ">>> ... w = " << q_arr(i,j,k,QW) << " c = " << qaux_arr(i,j,k,QC) << std::endl;
-                        std::cout << ">>> ... density = " << q_arr(i,j,k,QRHO) << std::endl;
-                    }
-
-                }
-#endif
-            }
-            else {
-
-                // method-of-lines constraint
-                Real courtmp = courx;
-                if (AMREX_SPACEDIM >= 2) {
-                    courtmp += coury;
-                }
-                if (AMREX_SPACEDIM == 3) {
-                    courtmp += courz;
-                }
+    const Box& domain = geom.Domain();
 
-#ifndef AMREX_USE_CUDA
-                if (verbose == 1) {
-
-                    // note: it might not be 1 for all RK integrators
-                    if (courtmp > 1.0_rt) {
-                        std::cout << std::endl;
-                        std::cout << "Warning:: CFL violation in check_for_cfl_violation" << std::endl;
-                        std::cout << ">>> ... at cell i = " << i << " j = " << j << " k = " << k << std::endl;
-                        std::cout << ">>> ... u = " << q_arr(i,j,k,QU) << " v = " << q_arr(i,j,k,QV)
-                                  << " w = " << q_arr(i,j,k,QW) << " c = " << qaux_arr(i,j,k,QC) << std::endl;
-                        std::cout << ">>> ... density = " << q_arr(i,j,k,QRHO) << std::endl;
-                    }
-
-                }
-#endif
-
-                return {courtmp};
-
-            }
-
-        });
+    Long index = max_courant_key & ((Long(1) << 40) - 1);
 
+    for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+        max_courant_loc[i] = domain.smallEnd(i) + static_cast<int>(index % domain.length(i));
+        index /= domain.length(i);
     }
 
-    ReduceTuple hv = reduce_data.value();
-    Real courno = amrex::get<0>(hv);
-
-    ParallelDescriptor::ReduceRealMax(courno);
-
-    if (courno > 1.0) {
-        amrex::Print() << "WARNING -- EFFECTIVE CFL AT LEVEL " << level << " IS " << courno << std::endl << std::endl;
+    if (max_courant > 1.0) {
+        amrex::Print() << "WARNING -- EFFECTIVE CFL AT LEVEL " << level << " IS " << max_courant
+                       << " AT ZONE " << max_courant_loc << std::endl << std::endl;
 
         cfl_violation = 1;
     }
+    else if (verbose > 1) {
+        amrex::Print() << "... maximum Courant number at level " << level << " is " << max_courant
+                       << " at zone " << max_courant_loc << std::endl << std::endl;
+    }
 
 }
@@ -2,6 +2,7 @@
 #include "Castro_F.H"
 #include "Castro_util.H"
 #include "Castro_hydro_F.H"
+#include "Castro_perf_log.H"
 
 #ifdef DIFFUSION
 #include "diffusion_util.H"
@@ -25,6 +26,8 @@ Castro::construct_mol_hydro_source(Real time, Real dt, MultiFab& A_update)
 
   BL_PROFILE("Castro::construct_mol_hydro_source()");
 
+  PerfRegion perf_region(PerfLog::Hydro);
+
 
   const Real strt_time = ParallelDescriptor::second();
 
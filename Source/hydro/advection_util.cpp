@@ -14,6 +14,7 @@
 #endif
 
 #include "eos.H"
+#include "Castro_eos_batch.H"
 
 using namespace amrex;
 
@@ -52,6 +53,71 @@ Castro::ctoprim(const Box& bx,
   get_omega(time, omega.begin());
 #endif
 
+  // The EOS call is split into filling its input from q and storing
+  // its output, so that it can be done either zone by zone in the
+  // kernel below or in batches afterwards.
+
+  const bool batched = eos_batch_enabled(eos_batch_ctoprim);
+
+  auto eos_gather = [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k, eos_t& eos_state)
+  {
+    eos_state.T = q_arr(i,j,k,QTEMP);
+    eos_state.rho = q_arr(i,j,k,QRHO);
+    eos_state.e = q_arr(i,j,k,QREINT);
+    for (int n = 0; n < NumSpec; n++) {
+      eos_state.xn[n]  = q_arr(i,j,k,QFS+n);
+    }
+    for (int n = 0; n < NumAux; n++) {
+      eos_state.aux[n] = q_arr(i,j,k,QFX+n);
+    }
+  };
+
+  auto eos_scatter = [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k, eos_t const& eos_state)
+  {
+    q_arr(i,j,k,QTEMP) = eos_state.T;
+    q_arr(i,j,k,QREINT) = eos_state.e * q_arr(i,j,k,QRHO);
+    q_arr(i,j,k,QPRES) = eos_state.p;
+#ifdef TRUE_SDC
+    q_arr(i,j,k,QGC) = eos_state.gam1;
+#endif
+
+#ifdef RADIATION
+    qaux_arr(i,j,k,QGAMCG) = eos_state.gam1;
+    qaux_arr(i,j,k,QCG) = eos_state.cs;
+
+    Real lams[NGROUPS];
+    for (int g = 0; g < NGROUPS; g++) {
+      lams[g] = lam(i,j,k,g);
+    }
+    Real qs[NQ];
+    for (int n = 0; n < NQ; n++) {
+      qs[n] = q_arr(i,j,k,n);
+    }
+    Real ptot;
+    Real ctot;
+    Real gamc_tot;
+    compute_ptot_ctot(lams, qs,
+                      is_comoving, limiter, closure,
+                      qaux_arr(i,j,k,QCG),
+                      ptot, ctot, gamc_tot);
+
+    q_arr(i,j,k,QPTOT) = ptot;
+
+    qaux_arr(i,j,k,QC) = ctot;
+    qaux_arr(i,j,k,QGAMC) = gamc_tot;
+
+    q_arr(i,j,k,QREITOT) = q_arr(i,j,k,QREINT);
+    for (int g = 0; g < NGROUPS; g++) {
+      qaux_arr(i,j,k,QLAMS+g) = lam(i,j,k,g);
+      q_arr(i,j,k,QREITOT) += q_arr(i,j,k,QRAD+g);
+    }
+
+#else
+    qaux_arr(i,j,k,QGAMC) = eos_state.gam1;
+    qaux_arr(i,j,k,QC) = eos_state.cs;
+#endif
+  };
+
   AMREX_PARALLEL_FOR_3D(bx, i, j, k,
   {
 
@@ -130,63 +196,18 @@ Castro::ctoprim(const Box& bx,
     }
 
     // get gamc, p, T, c, csml using q state
-    eos_t eos_state;
-    eos_state.T = q_arr(i,j,k,QTEMP);
-    eos_state.rho = q_arr(i,j,k,QRHO);
-    eos_state.e = q_arr(i,j,k,QREINT);
-    for (int n = 0; n < NumSpec; n++) {
-      eos_state.xn[n]  = q_arr(i,j,k,QFS+n);
+    if (!batched) {
+      eos_t eos_state;
+      eos_gather(i, j, k, eos_state);
+      eos(eos_input_re, eos_state);
+      eos_scatter(i, j, k, eos_state);
     }
-    for (int n = 0; n < NumAux; n++) {
-      eos_state.aux[n] = q_arr(i,j,k,QFX+n);
-    }
-
-    eos(eos_input_re, eos_state);
-
-    q_arr(i,j,k,QTEMP) = eos_state.T;
-    q_arr(i,j,k,QREINT) = eos_state.e * q_arr(i,j,k,QRHO);
-    q_arr(i,j,k,QPRES) = eos_state.p;
-#ifdef TRUE_SDC
-    q_arr(i,j,k,QGC) = eos_state.gam1;
-#endif
-
-#ifdef RADIATION
-    qaux_arr(i,j,k,QGAMCG) = eos_state.gam1;
-    qaux_arr(i,j,k,QCG) = eos_state.cs;
-
-    Real lams[NGROUPS];
-    for (int g = 0; g < NGROUPS; g++) {
-      lams[g] = lam(i,j,k,g);
-    }
-    Real qs[NQ];
-    for (int n = 0; n < NQ; n++) {
-      qs[n] = q_arr(i,j,k,n);
-    }
-    Real ptot;
-    Real ctot;
-    Real gamc_tot;
-    compute_ptot_ctot(lams, qs,
-                      is_comoving, limiter, closure,
-                      qaux_arr(i,j,k,QCG),
-                      ptot, ctot, gamc_tot);
-
-    q_arr(i,j,k,QPTOT) = ptot;
-
-    qaux_arr(i,j,k,QC) = ctot;
-    qaux_arr(i,j,k,QGAMC) = gamc_tot;
-
-    q_arr(i,j,k,QREITOT) = q_arr(i,j,k,QREINT);
-    for (int g = 0; g < NGROUPS; g++) {
-      qaux_arr(i,j,k,QLAMS+g) = lam(i,j,k,g);
-      q_arr(i,j,k,QREITOT) += q_arr(i,j,k,QRAD+g);
-    }
-
-#else
-    qaux_arr(i,j,k,QGAMC) = eos_state.gam1;
-    qaux_arr(i,j,k,QC) = eos_state.cs;
-#endif
 
   });
+
+  if (batched) {
+    eos_apply(bx, eos_input_re, true, eos_gather, eos_scatter);
+  }
 }
 
 
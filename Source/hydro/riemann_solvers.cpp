@@ -14,13 +14,13 @@
 
 using namespace amrex;
 
+template <int idir>
 void
-Castro::riemanncg(const Box& bx,
-                  Array4<Real> const ql,
-                  Array4<Real> const qr,
-                  Array4<Real const> const qaux_arr,
-                  Array4<Real> const qint,
-                  const int idir) {
+Castro::actual_riemanncg(const Box& bx,
+                         Array4<Real> const ql,
+                         Array4<Real> const qr,
+                         Array4<Real const> const qaux_arr,
+                         Array4<Real> const qint) {
 
   // this implements the approximate Riemann solver of Colella & Glaz
   // (1985)
@@ -570,16 +570,17 @@ Castro::riemanncg(const Box& bx,
 
 }
 
+template <int idir>
 void
-Castro::riemannus(const Box& bx,
-                  Array4<Real> const ql,
-                  Array4<Real> const qr,
-                  Array4<Real const> const qaux_arr,
-                  Array4<Real> const qint,
+Castro::actual_riemannus(const Box& bx,
+                         Array4<Real> const ql,
+                         Array4<Real> const qr,
+                         Array4<Real const> const qaux_arr,
+                         Array4<Real> const qint,
 #ifdef RADIATION
-                  Array4<Real> const lambda_int,
+                         Array4<Real> const lambda_int,
 #endif
-                  const int idir, const int compute_gammas) {
+                         const int compute_gammas) {
 
   // Colella, Glaz, and Ferguson solver
   //
@@ -1051,14 +1052,14 @@ Castro::riemannus(const Box& bx,
 }
 
 
+template <int idir, int coord>
 void
-Castro::HLLC(const Box& bx,
-             Array4<Real const> const ql,
-             Array4<Real const> const qr,
-             Array4<Real const> const qaux_arr,
-             Array4<Real> const uflx,
-             Array4<Real> const qint,
-             const int idir) {
+Castro::actual_HLLC(const Box& bx,
+                    Array4<Real const> const ql,
+                    Array4<Real const> const qr,
+                    Array4<Real const> const qaux_arr,
+                    Array4<Real> const uflx,
+                    Array4<Real> const qint) {
 
   // this is an implementation of the HLLC solver described in Toro's
   // book.  it uses the simplest estimate of the wave speeds, since
@@ -1116,8 +1117,6 @@ Castro::HLLC(const Box& bx,
     qpass_map_p[n] = qpass_map[n];
   }
 
-  int coord = geom.Coord();
-
   AMREX_PARALLEL_FOR_3D(bx, i, j, k,
   {
 
@@ -1469,3 +1468,90 @@ Castro::HLL(const Real* ql, const Real* qr,
     flux_hll[n] = (bp*fl_tmp - bm*fr_tmp)*bd + bp*bm*bd*(qr[QRHO]*qr[nqs] - ql[QRHO]*ql[nqs]);
   }
 }
+
+
+
+void
+Castro::riemanncg(const Box& bx,
+                  Array4<Real> const ql,
+                  Array4<Real> const qr,
+                  Array4<Real const> const qaux_arr,
+                  Array4<Real> const qint,
+                  const int idir) {
+
+  using kernel_t = decltype(&Castro::actual_riemanncg<0>);
+
+  static const kernel_t kernels[AMREX_SPACEDIM] = {
+    AMREX_D_DECL(&Castro::actual_riemanncg<0>,
+                 &Castro::actual_riemanncg<1>,
+                 &Castro::actual_riemanncg<2>)
+  };
+
+  (this->*kernels[idir])(bx, ql, qr, qaux_arr, qint);
+}
+
+
+
+void
+Castro::riemannus(const Box& bx,
+                  Array4<Real> const ql,
+                  Array4<Real> const qr,
+                  Array4<Real const> const qaux_arr,
+                  Array4<Real> const qint,
+#ifdef RADIATION
+                  Array4<Real> const lambda_int,
+#endif
+                  const int idir, const int compute_gammas) {
+
+  using kernel_t = decltype(&Castro::actual_riemannus<0>);
+
+  static const kernel_t kernels[AMREX_SPACEDIM] = {
+    AMREX_D_DECL(&Castro::actual_riemannus<0>,
+                 &Castro::actual_riemannus<1>,
+                 &Castro::actual_riemannus<2>)
+  };
+
+  (this->*kernels[idir])(bx, ql, qr, qaux_arr, qint,
+#ifdef RADIATION
+                         lambda_int,
+#endif
+                         compute_gammas);
+}
+
+
+
+void
+Castro::HLLC(const Box& bx,
+             Array4<Real const> const ql,
+             Array4<Real const> const qr,
+             Array4<Real const> const qaux_arr,
+             Array4<Real> const uflx,
+             Array4<Real> const qint,
+             const int idir) {
+
+  // The coordinate system only matters for the momentum flux in the
+  // radial direction, and 3-d is always Cartesian.
+
+  using kernel_t = decltype(&Castro::actual_HLLC<0, 0>);
+
+#if AMREX_SPACEDIM == 3
+  static const kernel_t kernels[AMREX_SPACEDIM] = {
+    &Castro::actual_HLLC<0, 0>,
+    &Castro::actual_HLLC<1, 0>,
+    &Castro::actual_HLLC<2, 0>
+  };
+
+  const kernel_t kernel = kernels[idir];
+#else
+  static const kernel_t kernels[AMREX_SPACEDIM][3] = {
+    {&Castro::actual_HLLC<0, 0>, &Castro::actual_HLLC<0, 1>, &Castro::actual_HLLC<0, 2>},
+#if AMREX_SPACEDIM == 2
+    {&Castro::actual_HLLC<1, 0>, &Castro::actual_HLLC<1, 1>, &Castro::actual_HLLC<1, 2>}
+#endif
+  };
+
+  const kernel_t kernel = kernels[idir][geom.Coord()];
+#endif
+
+  (this->*kernel)(bx, ql, qr, qaux_arr, uflx, qint);
+}
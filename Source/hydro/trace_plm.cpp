@@ -13,19 +13,20 @@
 
 using namespace amrex;
 
+template <int idir, bool curvilinear>
 void
-Castro::trace_plm(const Box& bx, const int idir,
-                  Array4<Real const> const q_arr,
-                  Array4<Real const> const qaux_arr,
-                  Array4<Real const> const dq,
-                  Array4<Real> const qm,
-                  Array4<Real> const qp,
+Castro::actual_trace_plm(const Box& bx,
+                         Array4<Real const> const q_arr,
+                         Array4<Real const> const qaux_arr,
+                         Array4<Real const> const dq,
+                         Array4<Real> const qm,
+                         Array4<Real> const qp,
 #if AMREX_SPACEDIM < 3
-                  Array4<Real const> const dloga,
+                         Array4<Real const> const dloga,
 #endif
-                  Array4<Real const> const srcQ,
-                  const Box& vbx,
-                  const Real dt) {
+                         Array4<Real const> const srcQ,
+                         const Box& vbx,
+                         const Real dt) {
 
   // here, bx is the box we loop over -- this can include ghost cells
   // vbx is the valid box (no ghost cells)
@@ -225,7 +226,7 @@ Castro::trace_plm(const Box& bx, const int idir,
 
 #if (AMREX_SPACEDIM < 3)
     // geometry source terms -- these only apply to the x-states
-    if (idir == 0 && dloga(i,j,k) != 0.0_rt) {
+    if (curvilinear && idir == 0 && dloga(i,j,k) != 0.0_rt) {
       Real courn = dtdx*(cc + abs(un));
       Real eta = (1.0_rt-courn)/(cc*dt*abs(dloga(i,j,k)));
       Real dlogatmp = amrex::min(eta, 1.0_rt)*dloga(i,j,k);
@@ -291,3 +292,43 @@ Castro::trace_plm(const Box& bx, const int idir,
 
   });
 }
+
+
+void
+Castro::trace_plm(const Box& bx, const int idir,
+                  Array4<Real const> const q_arr,
+                  Array4<Real const> const qaux_arr,
+                  Array4<Real const> const dq,
+                  Array4<Real> const qm,
+                  Array4<Real> const qp,
+#if AMREX_SPACEDIM < 3
+                  Array4<Real const> const dloga,
+#endif
+                  Array4<Real const> const srcQ,
+                  const Box& vbx,
+                  const Real dt) {
+
+  // dispatch to the kernel for this direction and geometry
+
+  using kernel_t = decltype(&Castro::actual_trace_plm<0, false>);
+
+  static const kernel_t kernels[AMREX_SPACEDIM][2] = {
+    {&Castro::actual_trace_plm<0, false>, &Castro::actual_trace_plm<0, true>},
+#if AMREX_SPACEDIM >= 2
+    {&Castro::actual_trace_plm<1, false>, &Castro::actual_trace_plm<1, true>},
+#endif
+#if AMREX_SPACEDIM == 3
+    {&Castro::actual_trace_plm<2, false>, &Castro::actual_trace_plm<2, true>},
+#endif
+  };
+
+  const int curvilinear = geom.Coord() != 0 ? 1 : 0;
+
+  (this->*kernels[idir][curvilinear])(bx,
+                                      q_arr, qaux_arr, dq,
+                                      qm, qp,
+#if AMREX_SPACEDIM < 3
+                                      dloga,
+#endif
+                                      srcQ, vbx, dt);
+}
@@ -12,20 +12,20 @@
 
 using namespace amrex;
 
+template <int idir, bool curvilinear>
 void
-Castro::trace_ppm(const Box& bx,
-                  const int idir,
-                  Array4<Real const> const q_arr,
-                  Array4<Real const> const qaux_arr,
-                  Array4<Real const> const srcQ,
-                  Array4<Real const> const flatn,
-                  Array4<Real> const qm,
-                  Array4<Real> const qp,
+Castro::actual_trace_ppm(const Box& bx,
+                         Array4<Real const> const q_arr,
+                         Array4<Real const> const qaux_arr,
+                         Array4<Real const> const srcQ,
+                         Array4<Real const> const flatn,
+                         Array4<Real> const qm,
+                         Array4<Real> const qp,
 #if (AMREX_SPACEDIM < 3)
-                  Array4<Real const> const dloga,
+                         Array4<Real const> const dloga,
 #endif
-                  const Box& vbx,
-                  const Real dt) {
+                         const Box& vbx,
+                         const Real dt) {
 
   // here, lo and hi are the range we loop over -- this can include ghost cells
   // vlo and vhi are the bounds of the valid box (no ghost cells)
@@ -529,7 +529,7 @@ Castro::trace_ppm(const Box& bx,
     // geometry source terms
 #if (AMREX_SPACEDIM < 3)
     // these only apply for x states (idir = 0)
-    if (idir == 0 && dloga(i,j,k) != 0.0_rt) {
+    if (curvilinear && idir == 0 && dloga(i,j,k) != 0.0_rt) {
       Real courn = dt/dx[0]*(cc+std::abs(un));
       Real eta = (1.0_rt - courn)/(cc*dt*std::abs(dloga(i,j,k)));
       Real dlogatmp = amrex::min(eta, 1.0_rt)*dloga(i,j,k);
@@ -557,3 +557,44 @@ Castro::trace_ppm(const Box& bx,
 }
 
 
+void
+Castro::trace_ppm(const Box& bx,
+                  const int idir,
+                  Array4<Real const> const q_arr,
+                  Array4<Real const> const qaux_arr,
+                  Array4<Real const> const srcQ,
+                  Array4<Real const> const flatn,
+                  Array4<Real> const qm,
+                  Array4<Real> const qp,
+#if (AMREX_SPACEDIM < 3)
+                  Array4<Real const> const dloga,
+#endif
+                  const Box& vbx,
+                  const Real dt) {
+
+  // The direction and the geometry are fixed for the whole box, so we
+  // select the kernel compiled for them here rather than testing them
+  // for every zone.
+
+  using kernel_t = decltype(&Castro::actual_trace_ppm<0, false>);
+
+  static const kernel_t kernels[AMREX_SPACEDIM][2] = {
+    {&Castro::actual_trace_ppm<0, false>, &Castro::actual_trace_ppm<0, true>},
+#if AMREX_SPACEDIM >= 2
+    {&Castro::actual_trace_ppm<1, false>, &Castro::actual_trace_ppm<1, true>},
+#endif
+#if AMREX_SPACEDIM == 3
+    {&Castro::actual_trace_ppm<2, false>, &Castro::actual_trace_ppm<2, true>},
+#endif
+  };
+
+  const int curvilinear = geom.Coord() != 0 ? 1 : 0;
+
+  (this->*kernels[idir][curvilinear])(bx,
+                                      q_arr, qaux_arr, srcQ, flatn,
+                                      qm, qp,
+#if (AMREX_SPACEDIM < 3)
+                                      dloga,
+#endif
+                                      vbx, dt);
+}
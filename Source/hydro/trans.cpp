@@ -30,42 +30,62 @@ Castro::trans_single(const Box& bx,
 #endif
                      Real hdt, Real cdtdx)
 {
+    // Select the kernel for this pair of directions; the table is
+    // indexed by [idir_t][idir_n].
+
+    using kernel_t = decltype(&Castro::actual_trans_single<1, 0>);
+
+    static const kernel_t kernels[AMREX_SPACEDIM][AMREX_SPACEDIM] = {
+#if AMREX_SPACEDIM == 2
+        {nullptr, &Castro::actual_trans_single<0, 1>},
+        {&Castro::actual_trans_single<1, 0>, nullptr}
+#else
+        {nullptr, &Castro::actual_trans_single<0, 1>, &Castro::actual_trans_single<0, 2>},
+        {&Castro::actual_trans_single<1, 0>, nullptr, &Castro::actual_trans_single<1, 2>},
+        {&Castro::actual_trans_single<2, 0>, &Castro::actual_trans_single<2, 1>, nullptr}
+#endif
+    };
+
+    const kernel_t kernel = kernels[idir_t][idir_n];
+
+    AMREX_ASSERT(kernel != nullptr);
+
     // Evaluate the transverse terms for both
     // the minus and plus states.
 
-    actual_trans_single(bx, idir_t, idir_n, -1,
-                        qm, qmo,
-                        qaux_arr,
-                        flux_t,
+    (this->*kernel)(bx, -1,
+                    qm, qmo,
+                    qaux_arr,
+                    flux_t,
 #ifdef RADIATION
-                        rflux_t,
+                    rflux_t,
 #endif
-                        q_t,
+                    q_t,
 #if AMREX_SPACEDIM == 2
-                        area_t,
-                        vol,
+                    area_t,
+                    vol,
 #endif
-                        hdt, cdtdx);
+                    hdt, cdtdx);
 
-    actual_trans_single(bx, idir_t, idir_n, 0,
-                        qp, qpo,
-                        qaux_arr,
-                        flux_t,
+    (this->*kernel)(bx, 0,
+                    qp, qpo,
+                    qaux_arr,
+                    flux_t,
 #ifdef RADIATION
-                        rflux_t,
+                    rflux_t,
 #endif
-                        q_t,
+                    q_t,
 #if AMREX_SPACEDIM == 2
-                        area_t,
-                        vol,
+                    area_t,
+                    vol,
 #endif
-                        hdt, cdtdx);
+                    hdt, cdtdx);
 }
 
 
+template <int idir_t, int idir_n>
 void
-Castro::actual_trans_single(const Box& bx,
-                            int idir_t, int idir_n, int d,
+Castro::actual_trans_single(const Box& bx, int d,
                             Array4<Real const> const q_arr,
                             Array4<Real> const qo_arr,
                             Array4<Real const> const qaux_arr,
@@ -448,46 +468,61 @@ Castro::trans_final(const Box& bx,
                     Array4<Real const> const q_t2,
                     Real hdt, Real cdtdx_n, Real cdtdx_t1, Real cdtdx_t2)
 {
+    // The two transverse directions follow from the normal one, so
+    // the kernel only needs to be looked up by idir_n.
+
+    using kernel_t = decltype(&Castro::actual_trans_final<0, 1, 2>);
+
+    static const kernel_t kernels[3] = {
+        &Castro::actual_trans_final<0, 1, 2>,
+        &Castro::actual_trans_final<1, 0, 2>,
+        &Castro::actual_trans_final<2, 0, 1>
+    };
+
+    AMREX_ASSERT(idir_t1 == (idir_n == 0 ? 1 : 0));
+    AMREX_ASSERT(idir_t2 == (idir_n == 2 ? 1 : 2));
+    amrex::ignore_unused(idir_t1, idir_t2);
+
     // Evaluate the transverse terms for both
     // the minus and plus states.
 
-    actual_trans_final(bx, idir_n, idir_t1, idir_t2, -1,
-                       qm, qmo,
-                       qaux_arr,
-                       flux_t1,
+    (this->*kernels[idir_n])(bx, -1,
+                             qm, qmo,
+                             qaux_arr,
+                             flux_t1,
 #ifdef RADIATION
-                       rflux_t1,
+                             rflux_t1,
 #endif
-                       flux_t2,
+                             flux_t2,
 #ifdef RADIATION
-                       rflux_t2,
+                             rflux_t2,
 #endif
-                       q_t1,
-                       q_t2,
-                       hdt, cdtdx_n, cdtdx_t1, cdtdx_t2);
+                             q_t1,
+                             q_t2,
+                             hdt, cdtdx_n, cdtdx_t1, cdtdx_t2);
 
-    actual_trans_final(bx, idir_n, idir_t1, idir_t2, 0,
-                       qp, qpo,
-                       qaux_arr,
-                       flux_t1,
+    (this->*kernels[idir_n])(bx, 0,
+                             qp, qpo,
+                             qaux_arr,
+                             flux_t1,
 #ifdef RADIATION
-                       rflux_t1,
+                             rflux_t1,
 #endif
-                       flux_t2,
+                             flux_t2,
 #ifdef RADIATION
-                       rflux_t2,
+                             rflux_t2,
 #endif
-                       q_t1,
-                       q_t2,
-                       hdt, cdtdx_n, cdtdx_t1, cdtdx_t2);
+                             q_t1,
+                             q_t2,
+                             hdt, cdtdx_n, cdtdx_t1, cdtdx_t2);
 
 }
 
 
 
+template <int idir_n, int idir_t1, int idir_t2>
 void
-Castro::actual_trans_final(const Box& bx,
-                           int idir_n, int idir_t1, int idir_t2, int d,
+Castro::actual_trans_final(const Box& bx, int d,
                            Array4<Real const> const q_arr,
                            Array4<Real> const qo_arr,
                            Array4<Real const> const qaux_arr,
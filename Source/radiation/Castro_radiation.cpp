@@ -1,6 +1,7 @@
 
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_perf_log.H"
 
 using std::string;
 
@@ -12,6 +13,8 @@ using namespace amrex;
 void
 Castro::final_radiation_call (MultiFab& S_new, int iteration, int ncycle) 
 {
+    PerfRegion perf_region(PerfLog::Radiation);
+
     if (do_radiation) {
 
         if (Radiation::pure_hydro) {
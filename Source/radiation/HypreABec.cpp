@@ -49,7 +49,7 @@ HypreABec::HypreABec(const BoxArray& grids,
                      const DistributionMapping& dmap,
                      const Geometry& _geom,
                      int _solver_flag)
-  : geom(_geom), solver_flag(_solver_flag)
+  : geom(_geom), solver_flag(_solver_flag), solver_ready(false)
 {
   ParmParse pp("habec");
 
@@ -204,6 +204,10 @@ HypreABec::HypreABec(const BoxArray& grids,
 
 HypreABec::~HypreABec()
 {
+  if (solver_ready) {
+    clearSolver();
+  }
+
   HYPRE_StructVectorDestroy(b);
   HYPRE_StructVectorDestroy(x);
 
@@ -354,9 +358,9 @@ void HypreABec::getFaceMetric(Vector<Real>& r,
   }
 }
 
-void HypreABec::setupSolver(Real _reltol, Real _abstol, int maxiter)
+void HypreABec::loadMatrix()
 {
-  BL_PROFILE("HypreABec::setupSolver");
+  BL_PROFILE("HypreABec::loadMatrix");
 
   const BoxArray& grids = acoefs->boxArray();
 
@@ -466,6 +470,13 @@ void HypreABec::setupSolver(Real _reltol, Real _abstol, int maxiter)
 
   HYPRE_StructVectorAssemble(b); // currently a no-op
   HYPRE_StructVectorAssemble(x); // currently a no-op
+}
+
+void HypreABec::setupSolver(Real _reltol, Real _abstol, int maxiter)
+{
+  BL_PROFILE("HypreABec::setupSolver");
+
+  loadMatrix();
 
   reltol = _reltol;
   abstol = _abstol; // may be used to change tolerance for solve
@@ -598,6 +609,41 @@ void HypreABec::setupSolver(Real _reltol, Real _abstol, int maxiter)
       amrex::Error("HypreABec: no such solver");
   }
   Gpu::synchronize();
+
+  solver_ready = true;
+}
+
+void HypreABec::updateSolver(Real _reltol, Real _abstol)
+{
+  BL_PROFILE("HypreABec::updateSolver");
+
+  BL_ASSERT(solver_ready);
+
+  loadMatrix();
+
+  reltol = _reltol;
+  abstol = _abstol;
+
+  // solve may have loosened the tolerance for the last right hand side
+  setSolverTol(reltol);
+
+  Gpu::synchronize();
+}
+
+void HypreABec::setSolverTol(Real tol)
+{
+  if (solver_flag == 0) {
+    HYPRE_StructSMGSetTol(solver, tol);
+  }
+  else if(solver_flag == 1) {
+    HYPRE_StructPFMGSetTol(solver, tol);
+  }
+  else if(solver_flag == 2) {
+    // nothing for this option
+  }
+  else if(solver_flag == 3 || solver_flag == 4) {
+    HYPRE_StructPCGSetTol(solver, tol);
+  }
 }
 
 void HypreABec::clearSolver()
@@ -633,6 +679,8 @@ void HypreABec::clearSolver()
        HYPRE_StructSMGDestroy(precond);
     }
   }
+
+  solver_ready = false;
 }
 
 void HypreABec::solve(MultiFab& dest, int icomp, MultiFab& rhs, BC_Mode inhom)
@@ -759,18 +807,7 @@ void HypreABec::solve(MultiFab& dest, int icomp, MultiFab& rhs, BC_Mode inhom)
                        : reltol);
 
     if (reltol_new > reltol) {
-      if (solver_flag == 0) {
-        HYPRE_StructSMGSetTol(solver, reltol_new);
-      }
-      else if(solver_flag == 1) {
-        HYPRE_StructPFMGSetTol(solver, reltol_new);
-      }
-      else if(solver_flag == 2) {
-        // nothing for this option
-      }
-      else if(solver_flag == 3 || solver_flag == 4) {
-        HYPRE_StructPCGSetTol(solver, reltol_new);
-      }
+      setSolverTol(reltol_new);
     }
   }
 
@@ -858,6 +895,27 @@ void HypreABec::solve(MultiFab& dest, int icomp, MultiFab& rhs, BC_Mode inhom)
   Gpu::synchronize();
 }
 
+int HypreABec::getNumIterations()
+{
+  int num_iterations = 0;
+  if (solver_flag == 0) {
+    HYPRE_StructSMGGetNumIterations(solver, &num_iterations);
+  }
+  else if(solver_flag == 1) {
+    HYPRE_StructPFMGGetNumIterations(solver, &num_iterations);
+  }
+  else if(solver_flag == 2) {
+    HYPRE_StructJacobiGetNumIterations(solver, &num_iterations);
+  }
+  else if(solver_flag == 3 || solver_flag == 4) {
+    HYPRE_StructPCGGetNumIterations(solver, &num_iterations);
+  }
+  else if(solver_flag == 5 || solver_flag == 6) {
+    HYPRE_StructHybridGetNumIterations(solver, &num_iterations);
+  }
+  return num_iterations;
+}
+
 Real HypreABec::getAbsoluteResidual()
 {
   BL_PROFILE("HypreABec::getAbsoluteResidual");
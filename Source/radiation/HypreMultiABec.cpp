@@ -629,7 +629,8 @@ HypreMultiABec::HypreMultiABec(int _crse_level, int _fine_level,
     c_entry(fine_level+1),
     hgrid(NULL), stencil(NULL), graph(NULL),
     A(NULL), A0(NULL), b(NULL), x(NULL),
-    sstruct_solver(NULL), solver(NULL), precond(NULL)
+    sstruct_solver(NULL), solver(NULL), precond(NULL),
+    solver_ready(false)
 {
   ParmParse pp("hmabec");
 
@@ -687,6 +688,10 @@ HypreMultiABec::HypreMultiABec(int _crse_level, int _fine_level,
 
 HypreMultiABec::~HypreMultiABec()
 {
+  if (solver_ready) {
+    clearSolver();
+  }
+
   HYPRE_SStructVectorDestroy(b);
   HYPRE_SStructVectorDestroy(x);
 
@@ -2577,6 +2582,19 @@ void HypreMultiABec::setupSolver(Real _reltol, Real _abstol, int maxiter)
     std::cout << "HypreMultiABec: no such solver" << std::endl;
     exit(1);
   }
+
+  solver_ready = true;
+}
+
+void HypreMultiABec::updateSolver(Real _reltol, Real _abstol)
+{
+  BL_ASSERT(solver_ready);
+
+  reltol = _reltol;
+  abstol = _abstol;
+
+  // solve may have loosened the tolerance for the last right hand side
+  setSolverTol(reltol);
 }
 
 void HypreMultiABec::clearSolver()
@@ -2659,6 +2677,8 @@ void HypreMultiABec::clearSolver()
   sstruct_solver = NULL;
   solver         = NULL;
   precond        = NULL;
+
+  solver_ready = false;
 }
 
 void HypreMultiABec::solve()
@@ -2684,58 +2704,7 @@ void HypreMultiABec::solve()
                        : reltol);
 
     if (reltol_new > reltol) {
-      if (solver_flag == 100) {
-        HYPRE_BoomerAMGSetTol(solver, reltol_new);
-      }
-      else if(solver_flag == 101) {
-        HYPRE_SStructFACSetTol(sstruct_solver, reltol_new);
-      }
-      else if(solver_flag == 102) {
-        HYPRE_ParCSRGMRESSetTol(solver, reltol_new);
-      }
-      else if (solver_flag == 103 || solver_flag == 107) {
-        HYPRE_SStructGMRESSetTol(sstruct_solver, reltol_new);
-      }
-      else if(solver_flag == 1002) {
-        HYPRE_ParCSRPCGSetTol(solver, reltol_new);
-      }
-      else if (solver_flag == 1003) {
-        HYPRE_SStructPCGSetTol(sstruct_solver, reltol_new);
-      }
-      else if (solver_flag == 104 || solver_flag == 105) {
-        HYPRE_ParCSRGMRESSetTol(solver, reltol_new);
-        HYPRE_BoomerAMGSetTol(precond, reltol_new);
-      }
-      else if (solver_flag == 106) {
-        HYPRE_SStructSplitSetTol(sstruct_solver, reltol_new);
-      }
-      else if (solver_flag == 108) {
-        ParmParse pp("hmabec");
-#if (BL_SPACEDIM == 1)
-        int struct_flag = 0;
-#else
-        int struct_flag = 1;
-#endif
-        pp.query("struct_flag", struct_flag);
-        if (struct_flag == 0) {
-          HYPRE_StructSMGSetTol((HYPRE_StructSolver) solver, reltol_new);
-        }
-        else {
-          HYPRE_StructPFMGSetTol((HYPRE_StructSolver) solver, reltol_new);
-        }
-      }
-      else if (solver_flag == 109) {
-        HYPRE_StructGMRESSetTol((HYPRE_StructSolver) solver, reltol_new);
-      }
-      else if (solver_flag == 150) {
-        HYPRE_BoomerAMGSetTol(solver, reltol_new);
-      }
-      else if(solver_flag == 151 || solver_flag == 153) {
-        HYPRE_PCGSetTol(solver, reltol_new);
-      }
-      else if(solver_flag == 152) {
-        HYPRE_PCGSetTol(solver, reltol_new);
-      }
+      setSolverTol(reltol_new);
     }
   }
 
@@ -2904,69 +2873,7 @@ void HypreMultiABec::solve()
   if (verbose >= 2 && ParallelDescriptor::IOProcessor()) {
     int num_iterations;
     Real res;
-    if (solver_flag == 100) {
-      HYPRE_BoomerAMGGetNumIterations(solver, &num_iterations);
-      HYPRE_BoomerAMGGetFinalRelativeResidualNorm(solver, &res);
-    }
-    else if (solver_flag == 101) {
-      HYPRE_SStructFACGetNumIterations(sstruct_solver, &num_iterations);
-      HYPRE_SStructFACGetFinalRelativeResidualNorm(sstruct_solver, &res);
-    }
-    else if (solver_flag == 102) {
-      HYPRE_ParCSRGMRESGetNumIterations(solver, &num_iterations);
-      HYPRE_ParCSRGMRESGetFinalRelativeResidualNorm(solver, &res);
-    }
-    else if (solver_flag == 103 || solver_flag == 107) {
-      HYPRE_SStructGMRESGetNumIterations(sstruct_solver, &num_iterations);
-      HYPRE_SStructGMRESGetFinalRelativeResidualNorm(sstruct_solver, &res);
-    }
-    else if (solver_flag == 1002) {
-      HYPRE_ParCSRPCGGetNumIterations(solver, &num_iterations);
-      HYPRE_ParCSRPCGGetFinalRelativeResidualNorm(solver, &res);
-    }
-    else if (solver_flag == 1003) {
-      HYPRE_SStructPCGGetNumIterations(sstruct_solver, &num_iterations);
-      HYPRE_SStructPCGGetFinalRelativeResidualNorm(sstruct_solver, &res);
-    }
-    else if (solver_flag == 104 || solver_flag == 105) {
-      HYPRE_ParCSRGMRESGetNumIterations(solver, &num_iterations);
-      HYPRE_ParCSRGMRESGetFinalRelativeResidualNorm(solver, &res);
-    }
-    else if (solver_flag == 106) {
-      HYPRE_SStructSplitGetNumIterations(sstruct_solver, &num_iterations);
-      HYPRE_SStructSplitGetFinalRelativeResidualNorm(sstruct_solver, &res);
-    }
-    else if (solver_flag == 108) {
-      ParmParse pp("hmabec");
-#if (BL_SPACEDIM == 1)
-      int struct_flag = 0;
-#else
-      int struct_flag = 1;
-#endif
-      pp.query("struct_flag", struct_flag);
-      HYPRE_StructSolver& struct_solver = *(HYPRE_StructSolver*)&solver;
-      if (struct_flag == 0) {
-        HYPRE_StructSMGGetNumIterations(struct_solver, &num_iterations);
-        HYPRE_StructSMGGetFinalRelativeResidualNorm(struct_solver, &res);
-      }
-      else {
-        HYPRE_StructPFMGGetNumIterations(struct_solver, &num_iterations);
-        HYPRE_StructPFMGGetFinalRelativeResidualNorm(struct_solver, &res);
-      }
-    }
-    else if (solver_flag == 109) {
-      HYPRE_StructSolver& struct_solver = *(HYPRE_StructSolver*)&solver;
-      HYPRE_StructGMRESGetNumIterations(struct_solver, &num_iterations);
-      HYPRE_StructGMRESGetFinalRelativeResidualNorm(struct_solver, &res);
-    }
-    else if (solver_flag == 150) {
-      HYPRE_BoomerAMGGetNumIterations(solver, &num_iterations);
-      HYPRE_BoomerAMGGetFinalRelativeResidualNorm(solver, &res);
-    }
-    else if (solver_flag == 151 || solver_flag == 152 || solver_flag == 153) {
-      HYPRE_PCGGetNumIterations(solver, &num_iterations);
-      HYPRE_PCGGetFinalRelativeResidualNorm(solver, &res);
-    }
+    getSolverStats(num_iterations, res);
 
     if (num_iterations >= verbose_threshold) {
       int oldprec = std::cout.precision(20);
@@ -2983,6 +2890,140 @@ void HypreMultiABec::solve()
   }
 }
 
+void HypreMultiABec::setSolverTol(Real tol)
+{
+  if (solver_flag == 100) {
+    HYPRE_BoomerAMGSetTol(solver, tol);
+  }
+  else if(solver_flag == 101) {
+    HYPRE_SStructFACSetTol(sstruct_solver, tol);
+  }
+  else if(solver_flag == 102) {
+    HYPRE_ParCSRGMRESSetTol(solver, tol);
+  }
+  else if (solver_flag == 103 || solver_flag == 107) {
+    HYPRE_SStructGMRESSetTol(sstruct_solver, tol);
+  }
+  else if(solver_flag == 1002) {
+    HYPRE_ParCSRPCGSetTol(solver, tol);
+  }
+  else if (solver_flag == 1003) {
+    HYPRE_SStructPCGSetTol(sstruct_solver, tol);
+  }
+  else if (solver_flag == 104 || solver_flag == 105) {
+    HYPRE_ParCSRGMRESSetTol(solver, tol);
+    HYPRE_BoomerAMGSetTol(precond, tol);
+  }
+  else if (solver_flag == 106) {
+    HYPRE_SStructSplitSetTol(sstruct_solver, tol);
+  }
+  else if (solver_flag == 108) {
+    ParmParse pp("hmabec");
+#if (BL_SPACEDIM == 1)
+    int struct_flag = 0;
+#else
+    int struct_flag = 1;
+#endif
+    pp.query("struct_flag", struct_flag);
+    if (struct_flag == 0) {
+      HYPRE_StructSMGSetTol((HYPRE_StructSolver) solver, tol);
+    }
+    else {
+      HYPRE_StructPFMGSetTol((HYPRE_StructSolver) solver, tol);
+    }
+  }
+  else if (solver_flag == 109) {
+    HYPRE_StructGMRESSetTol((HYPRE_StructSolver) solver, tol);
+  }
+  else if (solver_flag == 150) {
+    HYPRE_BoomerAMGSetTol(solver, tol);
+  }
+  else if(solver_flag == 151 || solver_flag == 153) {
+    HYPRE_PCGSetTol(solver, tol);
+  }
+  else if(solver_flag == 152) {
+    HYPRE_PCGSetTol(solver, tol);
+  }
+}
+
+void HypreMultiABec::getSolverStats(int& num_iterations, Real& res)
+{
+  num_iterations = 0;
+  res = 0.0;
+
+  if (solver_flag == 100) {
+    HYPRE_BoomerAMGGetNumIterations(solver, &num_iterations);
+    HYPRE_BoomerAMGGetFinalRelativeResidualNorm(solver, &res);
+  }
+  else if (solver_flag == 101) {
+    HYPRE_SStructFACGetNumIterations(sstruct_solver, &num_iterations);
+    HYPRE_SStructFACGetFinalRelativeResidualNorm(sstruct_solver, &res);
+  }
+  else if (solver_flag == 102) {
+    HYPRE_ParCSRGMRESGetNumIterations(solver, &num_iterations);
+    HYPRE_ParCSRGMRESGetFinalRelativeResidualNorm(solver, &res);
+  }
+  else if (solver_flag == 103 || solver_flag == 107) {
+    HYPRE_SStructGMRESGetNumIterations(sstruct_solver, &num_iterations);
+    HYPRE_SStructGMRESGetFinalRelativeResidualNorm(sstruct_solver, &res);
+  }
+  else if (solver_flag == 1002) {
+    HYPRE_ParCSRPCGGetNumIterations(solver, &num_iterations);
+    HYPRE_ParCSRPCGGetFinalRelativeResidualNorm(solver, &res);
+  }
+  else if (solver_flag == 1003) {
+    HYPRE_SStructPCGGetNumIterations(sstruct_solver, &num_iterations);
+    HYPRE_SStructPCGGetFinalRelativeResidualNorm(sstruct_solver, &res);
+  }
+  else if (solver_flag == 104 || solver_flag == 105) {
+    HYPRE_ParCSRGMRESGetNumIterations(solver, &num_iterations);
+    HYPRE_ParCSRGMRESGetFinalRelativeResidualNorm(solver, &res);
+  }
+  else if (solver_flag == 106) {
+    HYPRE_SStructSplitGetNumIterations(sstruct_solver, &num_iterations);
+    HYPRE_SStructSplitGetFinalRelativeResidualNorm(sstruct_solver, &res);
+  }
+  else if (solver_flag == 108) {
+    ParmParse pp("hmabec");
+#if (BL_SPACEDIM == 1)
+    int struct_flag = 0;
+#else
+    int struct_flag = 1;
+#endif
+    pp.query("struct_flag", struct_flag);
+    HYPRE_StructSolver& struct_solver = *(HYPRE_StructSolver*)&solver;
+    if (struct_flag == 0) {
+      HYPRE_StructSMGGetNumIterations(struct_solver, &num_iterations);
+      HYPRE_StructSMGGetFinalRelativeResidualNorm(struct_solver, &res);
+    }
+    else {
+      HYPRE_StructPFMGGetNumIterations(struct_solver, &num_iterations);
+      HYPRE_StructPFMGGetFinalRelativeResidualNorm(struct_solver, &res);
+    }
+  }
+  else if (solver_flag == 109) {
+    HYPRE_StructSolver& struct_solver = *(HYPRE_StructSolver*)&solver;
+    HYPRE_StructGMRESGetNumIterations(struct_solver, &num_iterations);
+    HYPRE_StructGMRESGetFinalRelativeResidualNorm(struct_solver, &res);
+  }
+  else if (solver_flag == 150) {
+    HYPRE_BoomerAMGGetNumIterations(solver, &num_iterations);
+    HYPRE_BoomerAMGGetFinalRelativeResidualNorm(solver, &res);
+  }
+  else if (solver_flag == 151 || solver_flag == 152 || solver_flag == 153) {
+    HYPRE_PCGGetNumIterations(solver, &num_iterations);
+    HYPRE_PCGGetFinalRelativeResidualNorm(solver, &res);
+  }
+}
+
+int HypreMultiABec::getNumIterations()
+{
+  int num_iterations;
+  Real res;
+  getSolverStats(num_iterations, res);
+  return num_iterations;
+}
+
 void HypreMultiABec::getSolution(int level, MultiFab& dest, int icomp)
 {
   int part = level - crse_level;
@@ -53,66 +53,6 @@ void Radiation::check_convergence_er(Real& relative, Real& absolute, Real& err_e
 }
 
 
-void Radiation::check_convergence_matt(const MultiFab& rhoe_new, const MultiFab& rhoe_star, 
-                                       const MultiFab& rhoe_step, const MultiFab& Er_new, 
-                                       const MultiFab& temp_new, const MultiFab& temp_star, 
-                                       const MultiFab& rho,
-                                       const MultiFab& kappa_p, const MultiFab& jg,
-                                       const MultiFab& dedT,
-                                       Real& rel_rhoe, Real& abs_rhoe, 
-                                       Real& rel_FT,   Real& abs_FT, 
-                                       Real& rel_T,    Real& abs_T, 
-                                       Real delta_t)
-{
-  rel_rhoe = 0.0;
-  rel_FT   = 0.0;
-  rel_T    = 0.0;
-  abs_rhoe = 0.0;
-  abs_FT   = 0.0;
-  abs_T    = 0.0;
-
-#ifdef _OPENMP
-#pragma omp parallel reduction(max:rel_rhoe, abs_rhoe, rel_FT, abs_FT, rel_T, abs_T)
-#endif
-  for (MFIter mfi(rhoe_new, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
-      const Box& bx = mfi.tilebox();
-
-#pragma gpu box(bx)
-      ca_check_conv
-          (AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
-           BL_TO_FORTRAN_ANYD(rhoe_new[mfi]),
-           BL_TO_FORTRAN_ANYD(rhoe_star[mfi]),
-           BL_TO_FORTRAN_ANYD(rhoe_step[mfi]),
-           BL_TO_FORTRAN_ANYD(Er_new[mfi]),
-           BL_TO_FORTRAN_ANYD(temp_new[mfi]),
-           BL_TO_FORTRAN_ANYD(temp_star[mfi]),
-           BL_TO_FORTRAN_ANYD(rho[mfi]),
-           BL_TO_FORTRAN_ANYD(kappa_p[mfi]),
-           BL_TO_FORTRAN_ANYD(jg[mfi]),
-           BL_TO_FORTRAN_ANYD(dedT[mfi]),
-           AMREX_MFITER_REDUCE_MAX(&rel_rhoe),
-           AMREX_MFITER_REDUCE_MAX(&abs_rhoe),
-           AMREX_MFITER_REDUCE_MAX(&rel_FT),
-           AMREX_MFITER_REDUCE_MAX(&abs_FT),
-           AMREX_MFITER_REDUCE_MAX(&rel_T),
-           AMREX_MFITER_REDUCE_MAX(&abs_T),
-           delta_t);
-  }
-
-  int ndata = 6;
-  Real data[6] = {rel_rhoe, abs_rhoe, rel_FT, abs_FT, rel_T, abs_T};
-
-  ParallelDescriptor::ReduceRealMax(data, ndata);
-
-  rel_rhoe = data[0]; 
-  abs_rhoe = data[1];
-  rel_FT   = data[2];
-  abs_FT   = data[3];
-  rel_T    = data[4];
-  abs_T    = data[5];
-}
-
-
 void Radiation::compute_coupling(MultiFab& coupT,
                                  const MultiFab& kpp, const MultiFab& Eg,
                                  const MultiFab& jg)
@@ -162,73 +102,85 @@ void Radiation::compute_etat(MultiFab& etaT, MultiFab& etaTz,
 }
 
 
-void Radiation::eos_opacity_emissivity(const MultiFab& S_new, 
-                                       const MultiFab& temp_new,
-                                       const MultiFab& temp_star,
-                                       MultiFab& kappa_p, MultiFab& kappa_r, MultiFab& jg, 
-                                       MultiFab& djdT, MultiFab& dkdT, MultiFab& dedT,
-                                       int level, int it, int ngrow)
+int Radiation::lag_opacity(int it) const
 {
-  int star_is_valid = 1 - ngrow;
-
-  int lag_opac;
   if (it == 1) {
-    lag_opac = 0;
+    return 0;
   }
   else if (it <= update_opacity) {
-    lag_opac = 0;
+    return 0;
   }
   else {
-    lag_opac = 1;
+    return 1;
   }
+}
 
-  const Geometry& geom = parent->Geom(level);
 
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-  for (MFIter mfi(S_new, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
-      const Box& box = mfi.tilebox();
+void Radiation::eos_opacity_emissivity_tile(const MFIter& mfi,
+                                            const MultiFab& S_new,
+                                            const MultiFab& temp_new,
+                                            const MultiFab& temp_star,
+                                            MultiFab& kappa_p, MultiFab& kappa_r, MultiFab& jg,
+                                            MultiFab& djdT, MultiFab& dkdT, MultiFab& dedT,
+                                            int ngrow, int lag_opac)
+{
+  int star_is_valid = 1 - ngrow;
 
-#pragma gpu box(box)
-      ca_compute_c_v
-          (AMREX_INT_ANYD(box.loVect()), AMREX_INT_ANYD(box.hiVect()),
-           BL_TO_FORTRAN_ANYD(dedT[mfi]),
-           BL_TO_FORTRAN_ANYD(temp_new[mfi]),
-           BL_TO_FORTRAN_ANYD(S_new[mfi]));
-  }
+  const Box& reg = mfi.tilebox();
+
+#pragma gpu box(reg)
+  ca_compute_c_v
+      (AMREX_INT_ANYD(reg.loVect()), AMREX_INT_ANYD(reg.hiVect()),
+       BL_TO_FORTRAN_ANYD(dedT[mfi]),
+       BL_TO_FORTRAN_ANYD(temp_new[mfi]),
+       BL_TO_FORTRAN_ANYD(S_new[mfi]));
 
   if (dedT_fac > 1.0) {
-    dedT.mult(dedT_fac);
+    dedT[mfi].mult<RunOn::Device>(dedT_fac, reg);
   }
 
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-  for (MFIter mfi(S_new, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
-      const Box& bx = mfi.growntilebox(ngrow);
+  const Box& bx = mfi.growntilebox(ngrow);
 
 #pragma gpu box(bx)
-      ca_opacs
-          (AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
-           BL_TO_FORTRAN_ANYD(S_new[mfi]),
-           BL_TO_FORTRAN_ANYD(temp_new[mfi]),
-           BL_TO_FORTRAN_ANYD(temp_star[mfi]),
-           BL_TO_FORTRAN_ANYD(kappa_p[mfi]),
-           BL_TO_FORTRAN_ANYD(kappa_r[mfi]),
-           BL_TO_FORTRAN_ANYD(dkdT[mfi]),
-           use_dkdT, star_is_valid, lag_opac);
-
-      const Box& reg = mfi.tilebox();
+  ca_opacs
+      (AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+       BL_TO_FORTRAN_ANYD(S_new[mfi]),
+       BL_TO_FORTRAN_ANYD(temp_new[mfi]),
+       BL_TO_FORTRAN_ANYD(temp_star[mfi]),
+       BL_TO_FORTRAN_ANYD(kappa_p[mfi]),
+       BL_TO_FORTRAN_ANYD(kappa_r[mfi]),
+       BL_TO_FORTRAN_ANYD(dkdT[mfi]),
+       use_dkdT, star_is_valid, lag_opac);
 
 #pragma gpu box(reg)
-      ca_compute_emissivity
-          (AMREX_INT_ANYD(reg.loVect()), AMREX_INT_ANYD(reg.hiVect()),
-           BL_TO_FORTRAN_ANYD(jg[mfi]),  
-           BL_TO_FORTRAN_ANYD(djdT[mfi]),  
-           BL_TO_FORTRAN_ANYD(temp_new[mfi]),
-           BL_TO_FORTRAN_ANYD(kappa_p[mfi]),
-           BL_TO_FORTRAN_ANYD(dkdT[mfi]));
+  ca_compute_emissivity
+      (AMREX_INT_ANYD(reg.loVect()), AMREX_INT_ANYD(reg.hiVect()),
+       BL_TO_FORTRAN_ANYD(jg[mfi]),
+       BL_TO_FORTRAN_ANYD(djdT[mfi]),
+       BL_TO_FORTRAN_ANYD(temp_new[mfi]),
+       BL_TO_FORTRAN_ANYD(kappa_p[mfi]),
+       BL_TO_FORTRAN_ANYD(dkdT[mfi]));
+}
+
+
+void Radiation::eos_opacity_emissivity(const MultiFab& S_new, 
+                                       const MultiFab& temp_new,
+                                       const MultiFab& temp_star,
+                                       MultiFab& kappa_p, MultiFab& kappa_r, MultiFab& jg, 
+                                       MultiFab& djdT, MultiFab& dkdT, MultiFab& dedT,
+                                       int level, int it, int ngrow)
+{
+  int lag_opac = lag_opacity(it);
+
+  const Geometry& geom = parent->Geom(level);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+  for (MFIter mfi(S_new, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+      eos_opacity_emissivity_tile(mfi, S_new, temp_new, temp_star,
+                                  kappa_p, kappa_r, jg, djdT, dkdT, dedT,
+                                  ngrow, lag_opac);
   }    
 
   if (ngrow == 0 && !lag_opac) {
@@ -507,19 +459,41 @@ void Radiation::update_matter(MultiFab& rhoe_new, MultiFab& temp_new,
                               const MultiFab& Er_new, const MultiFab& Er_pi,
                               const MultiFab& rhoe_star,
                               const MultiFab& rhoe_step,
+                              const MultiFab& temp_star,
                               const MultiFab& etaT, const MultiFab& etaTz,
                               const MultiFab& eta1,
                               const MultiFab& coupT,
-                              const MultiFab& kappa_p, const MultiFab& jg, 
-                              const MultiFab& mugT,
-                              const MultiFab& S_new, 
+                              MultiFab& kappa_p, MultiFab& kappa_r, MultiFab& jg,
+                              MultiFab& djdT, MultiFab& dkdT, MultiFab& dedT,
+                              const MultiFab& rho,
+                              const MultiFab& S_new,
                               int level, Real delta_t, Real ptc_tau,
-                              int it, bool conservative_update)
+                              int it, bool conservative_update,
+                              Real& rel_rhoe, Real& abs_rhoe,
+                              Real& rel_FT,   Real& abs_FT,
+                              Real& rel_T,    Real& abs_T)
 {
+    BL_PROFILE("Radiation::update_matter");
+
+    // Each tile is taken through the whole matter update while its data
+    // is in cache: the new rhoe and T, then the EOS, opacities and
+    // emissivities at the new T, and then its part of the convergence
+    // measure. The only communication is the reduction at the end (and
+    // the kappa_r ghost cells, if the opacities are not lagged).
+
+    const int lag_opac = lag_opacity(it+1);
+
+    rel_rhoe = 0.0;
+    rel_FT   = 0.0;
+    rel_T    = 0.0;
+    abs_rhoe = 0.0;
+    abs_FT   = 0.0;
+    abs_T    = 0.0;
+
 #ifdef _OPENMP
-#pragma omp parallel
+#pragma omp parallel reduction(max:rel_rhoe, abs_rhoe, rel_FT, abs_FT, rel_T, abs_T)
 #endif
-    for (MFIter mfi(rhoe_new,true); mfi.isValid(); ++mfi) {
+    for (MFIter mfi(rhoe_new, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
         const Box& bx = mfi.tilebox(); 
 
         if (conservative_update) {
@@ -565,7 +539,48 @@ void Radiation::update_matter(MultiFab& rhoe_new, MultiFab& temp_new,
                  BL_TO_FORTRAN_ANYD(temp_new[mfi]), 
                  BL_TO_FORTRAN_ANYD(S_new[mfi]));
         }
+
+        eos_opacity_emissivity_tile(mfi, S_new, temp_new, temp_star,
+                                    kappa_p, kappa_r, jg, djdT, dkdT, dedT,
+                                    0, lag_opac);
+
+#pragma gpu box(bx)
+        ca_check_conv
+            (AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+             BL_TO_FORTRAN_ANYD(rhoe_new[mfi]),
+             BL_TO_FORTRAN_ANYD(rhoe_star[mfi]),
+             BL_TO_FORTRAN_ANYD(rhoe_step[mfi]),
+             BL_TO_FORTRAN_ANYD(Er_new[mfi]),
+             BL_TO_FORTRAN_ANYD(temp_new[mfi]),
+             BL_TO_FORTRAN_ANYD(temp_star[mfi]),
+             BL_TO_FORTRAN_ANYD(rho[mfi]),
+             BL_TO_FORTRAN_ANYD(kappa_p[mfi]),
+             BL_TO_FORTRAN_ANYD(jg[mfi]),
+             BL_TO_FORTRAN_ANYD(dedT[mfi]),
+             AMREX_MFITER_REDUCE_MAX(&rel_rhoe),
+             AMREX_MFITER_REDUCE_MAX(&abs_rhoe),
+             AMREX_MFITER_REDUCE_MAX(&rel_FT),
+             AMREX_MFITER_REDUCE_MAX(&abs_FT),
+             AMREX_MFITER_REDUCE_MAX(&rel_T),
+             AMREX_MFITER_REDUCE_MAX(&abs_T),
+             delta_t);
     }  
+
+    if (!lag_opac) {
+        kappa_r.FillBoundary(parent->Geom(level).periodicity());
+    }
+
+    int ndata = 6;
+    Real data[6] = {rel_rhoe, abs_rhoe, rel_FT, abs_FT, rel_T, abs_T};
+
+    ParallelDescriptor::ReduceRealMax(data, ndata);
+
+    rel_rhoe = data[0]; 
+    abs_rhoe = data[1];
+    rel_FT   = data[2];
+    abs_FT   = data[3];
+    rel_T    = data[4];
+    abs_T    = data[5];
 }
 
 // ========================================================================
@@ -702,23 +717,42 @@ void Radiation::MGFLD_compute_scattering(FArrayBox& kappa_s, const FArrayBox& st
 
 void Radiation::bisect_matter(MultiFab& rhoe_new, MultiFab& temp_new, 
                               const MultiFab& rhoe_star, const MultiFab& temp_star, 
-                              const MultiFab& S_new, const BoxArray& grids, int level)
+                              MultiFab& kappa_p, MultiFab& kappa_r, MultiFab& jg,
+                              MultiFab& djdT, MultiFab& dkdT, MultiFab& dedT,
+                              const MultiFab& S_new, const BoxArray& grids, int level, int it)
 {
-  temp_new.plus(temp_star, 0, 1, 0);
-  temp_new.mult(0.5, 0);
+  BL_PROFILE("Radiation::bisect_matter");
+
+  const int lag_opac = lag_opacity(it+1);
 
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-  for (MFIter mfi(rhoe_new,true); mfi.isValid(); ++mfi) {
+  for (MFIter mfi(rhoe_new, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
       const Box& bx = mfi.tilebox();
 
+      Array4<Real> const T = temp_new.array(mfi);
+      Array4<Real const> const T_star = temp_star.array(mfi);
+
+      AMREX_PARALLEL_FOR_3D(bx, i, j, k,
+      {
+          T(i,j,k) = 0.5_rt * (T(i,j,k) + T_star(i,j,k));
+      });
+
 #pragma gpu box(bx)
       ca_get_rhoe
           (AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
            BL_TO_FORTRAN_ANYD(rhoe_new[mfi]),
            BL_TO_FORTRAN_ANYD(temp_new[mfi]), 
            BL_TO_FORTRAN_ANYD(S_new[mfi]));
+
+      eos_opacity_emissivity_tile(mfi, S_new, temp_new, temp_star,
+                                  kappa_p, kappa_r, jg, djdT, dkdT, dedT,
+                                  0, lag_opac);
+  }
+
+  if (!lag_opac) {
+      kappa_r.FillBoundary(parent->Geom(level).periodicity());
   }
 }
 
@@ -399,24 +399,16 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
       conservative_update = true;
     }
 
+    // this also computes the new opacities and emissivities, and the
+    // errors for the convergence check
     update_matter(rhoe_new, temp_new, Er_new, Er_pi,
-                  rhoe_star, rhoe_step,
+                  rhoe_star, rhoe_step, temp_star,
                   etaT, etaTz, eta1,
                   coupT,
-                  kappa_p, jg, mugT,
-                  S_new, level, delta_t, ptc_tau, it, conservative_update);
-
-    eos_opacity_emissivity(S_new, temp_new,
-                           temp_star, // input
-                           kappa_p, kappa_r, jg, 
-                           djdT, dkdT, dedT, // output
-                           level, it+1, 0);
-
-    check_convergence_matt(rhoe_new, rhoe_star, rhoe_step, Er_new,
-                           temp_new, temp_star, 
-                           rho, kappa_p, jg, dedT,
-                           rel_rhoe, abs_rhoe, rel_FT, abs_FT, rel_T, abs_T,
-                           delta_t);
+                  kappa_p, kappa_r, jg,
+                  djdT, dkdT, dedT,
+                  rho, S_new, level, delta_t, ptc_tau, it, conservative_update,
+                  rel_rhoe, abs_rhoe, rel_FT, abs_FT, rel_T, abs_T);
 
     Real relative_out, absolute_out;
 
@@ -474,13 +466,9 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
     if (!converged && it > n_bisect) {
       bisect_matter(rhoe_new, temp_new,
                     rhoe_star, temp_star,
-                    S_new, grids, level);
-
-      eos_opacity_emissivity(S_new, temp_new,
-                             temp_star, // input
-                             kappa_p, kappa_r, jg, 
-                             djdT, dkdT, dedT, // output
-                             level, it+1, 0);
+                    kappa_p, kappa_r, jg,
+                    djdT, dkdT, dedT,
+                    S_new, grids, level, it);
     }
    
   } while ( ((!converged || !inner_converged) && it<maxiter)
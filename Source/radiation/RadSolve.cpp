@@ -21,7 +21,8 @@
 using namespace amrex;
 
 RadSolve::RadSolve (Amr* Parent, int level, const BoxArray& grids, const DistributionMapping& dmap)
-    : parent(Parent)
+    : parent(Parent), solver_level(level),
+      num_solves(0), num_setups(0), setup_iterations(0), rebuild_solver(true)
 {
     read_params();
 
@@ -47,6 +48,15 @@ RadSolve::RadSolve (Amr* Parent, int level, const BoxArray& grids, const Distrib
     }
 }
 
+RadSolve::~RadSolve ()
+{
+    if (radsolve::reuse_solver == 1 && radsolve::verbose >= 1 &&
+        num_solves > 0 && ParallelDescriptor::IOProcessor()) {
+        std::cout << "RadSolve level " << solver_level << ": " << num_solves << " solves, "
+                  << num_setups << " solver setups" << std::endl;
+    }
+}
+
 void
 RadSolve::read_params ()
 {
@@ -100,6 +110,15 @@ RadSolve::read_params ()
         }
     }
 
+    if (radsolve::reuse_solver == 1) {
+        if (radsolve::level_solver_flag == 101) {
+            amrex::Error("radsolve.reuse_solver is not supported with the FAC solver (level_solver_flag = 101)");
+        }
+        if (radsolve::reuse_iter_factor < 1.0) {
+            amrex::Error("radsolve.reuse_iter_factor must be at least 1");
+        }
+    }
+
 }
 
 void RadSolve::levelInit(int level)
@@ -441,8 +460,14 @@ void RadSolve::levelSolve(int level,
   }
 
   if (hd) {
-    hd->setupSolver(radsolve::reltol, radsolve::abstol, radsolve::maxiter);
+    bool reused = prepareSolver(*hd);
     hd->solve(Er, igroup, rhs, Inhomogeneous_BC);
+    if (checkSolver(reused, hd->getNumIterations())) {
+      hd->clearSolver();
+      prepareSolver(*hd);
+      hd->solve(Er, igroup, rhs, Inhomogeneous_BC);
+      checkSolver(false, hd->getNumIterations());
+    }
     Real res = hd->getAbsoluteResidual();
     if (verbose >= 2 && ParallelDescriptor::IOProcessor()) {
       int oldprec = std::cout.precision(20);
@@ -450,15 +475,23 @@ void RadSolve::levelSolve(int level,
       std::cout.precision(oldprec);
     }
     res *= sync_absres_factor;
-    hd->clearSolver();
+    if (radsolve::reuse_solver == 0) {
+      hd->clearSolver();
+    }
   }
   else if (hm) {
     hm->loadMatrix();
     hm->finalizeMatrix();
     hm->loadLevelVectors(level, Er, igroup, rhs, Inhomogeneous_BC);
     hm->finalizeVectors();
-    hm->setupSolver(radsolve::reltol, radsolve::abstol, radsolve::maxiter);
+    bool reused = prepareSolver(*hm);
     hm->solve();
+    if (checkSolver(reused, hm->getNumIterations())) {
+      hm->clearSolver();
+      prepareSolver(*hm);
+      hm->solve();
+      checkSolver(false, hm->getNumIterations());
+    }
     hm->getSolution(level, Er, igroup);
     Real res = hm->getAbsoluteResidual();
     if (verbose >= 2 && ParallelDescriptor::IOProcessor()) {
@@ -467,15 +500,23 @@ void RadSolve::levelSolve(int level,
       std::cout.precision(oldprec);
     }
     res *= sync_absres_factor;
-    hm->clearSolver();
+    if (radsolve::reuse_solver == 0) {
+      hm->clearSolver();
+    }
   }
   else if (hem) {
     hem->loadMatrix();
     hem->finalizeMatrix();
     hem->loadLevelVectors(level, Er, igroup, rhs, Inhomogeneous_BC);
     hem->finalizeVectors();
-    hem->setupSolver(radsolve::reltol, radsolve::abstol, radsolve::maxiter);
+    bool reused = prepareSolver(*hem);
     hem->solve();
+    if (checkSolver(reused, hem->getNumIterations())) {
+      hem->clearSolver();
+      prepareSolver(*hem);
+      hem->solve();
+      checkSolver(false, hem->getNumIterations());
+    }
     hem->getSolution(level, Er, igroup);
     Real res = hem->getAbsoluteResidual();
     if (verbose >= 2 && ParallelDescriptor::IOProcessor()) {
@@ -484,8 +525,65 @@ void RadSolve::levelSolve(int level,
       std::cout.precision(oldprec);
     }
     res *= sync_absres_factor;
-    hem->clearSolver();
+    if (radsolve::reuse_solver == 0) {
+      hem->clearSolver();
+    }
+  }
+}
+
+template <class H>
+bool RadSolve::prepareSolver(H& h)
+{
+  if (radsolve::reuse_solver == 1 && h.solverReady() && !rebuild_solver) {
+    h.updateSolver(radsolve::reltol, radsolve::abstol);
+    return true;
+  }
+
+  if (h.solverReady()) {
+    h.clearSolver();
   }
+
+  h.setupSolver(radsolve::reltol, radsolve::abstol, radsolve::maxiter);
+
+  ++num_setups;
+  rebuild_solver = false;
+
+  return false;
+}
+
+bool RadSolve::checkSolver(bool reused, int iterations)
+{
+  ++num_solves;
+
+  if (radsolve::reuse_solver == 0) {
+    return false;
+  }
+
+  if (!reused) {
+    // This is the reference for the solves that reuse this setup.
+    setup_iterations = std::max(iterations, 1);
+    return false;
+  }
+
+  // The iteration counts are global, so every rank makes the same choice.
+
+  const bool failed = iterations >= radsolve::maxiter;
+
+  if (failed || iterations > radsolve::reuse_iter_factor * setup_iterations) {
+
+    rebuild_solver = true;
+
+    if (radsolve::verbose >= 1 && ParallelDescriptor::IOProcessor()) {
+      std::cout << "RadSolve level " << solver_level << ": " << iterations
+                << " iterations with a reused setup (" << setup_iterations
+                << " after the setup), redoing the setup"
+                << (failed ? " and the solve" : "") << "; "
+                << num_solves << " solves, " << num_setups << " setups so far" << std::endl;
+    }
+
+  }
+
+  return failed;
 }
 
 void RadSolve::levelFluxFaceToCenter(int level, const Array<MultiFab, BL_SPACEDIM>& Flux,
@@ -1,6 +1,8 @@
 
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_cost.H"
+#include "Castro_perf_log.H"
 
 #include "AMReX_DistributionMapping.H"
 
@@ -136,6 +138,39 @@ Castro::strang_react_second_half(Real time, Real dt)
     if (verbose)
         amrex::Print() << "... Leaving burner after completing half-timestep of burning." << std::endl << std::endl;
 
+    // The burn only sets the valid zones of the new-time reactions data.
+    // Fill its ghost zones with the rates from the first half of the burn,
+    // which were computed there, so that they are not left stale (they are
+    // written to checkpoints along with the valid data).
+
+    if (reactions.nGrow() > 0 && level <= castro::reactions_max_solve_level) {
+
+        const MultiFab& reactions_old = get_old_data(Reactions_Type);
+
+        const int nc = reactions.nComp();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(reactions); mfi.isValid(); ++mfi)
+        {
+            const Box& vbx = mfi.validbox();
+            const Box& gbx = mfi.fabbox();
+
+            auto r_new = reactions.array(mfi);
+            auto r_old = reactions_old.array(mfi);
+
+            amrex::ParallelFor(gbx, nc,
+            [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                if (!vbx.contains(IntVect(AMREX_D_DECL(i,j,k)))) {
+                    r_new(i,j,k,n) = r_old(i,j,k,n);
+                }
+            });
+        }
+
+    }
+
     state_burn.FillBoundary(geom.periodicity());
 
     clean_state(state_burn, time + 0.5 * dt, state_burn.nGrow());
@@ -152,6 +187,8 @@ Castro::react_state(MultiFab& s, MultiFab& r, const iMultiFab& m, Real time, Rea
 
     BL_PROFILE("Castro::react_state()");
 
+    PerfRegion perf_region(PerfLog::Burn);
+
     // Sanity check: should only be in here if we're doing CTU or MOL.
 
     if (time_integration_method != CornerTransportUpwind) {
@@ -173,10 +210,15 @@ Castro::react_state(MultiFab& s, MultiFab& r, const iMultiFab& m, Real time, Rea
         FillCoarsePatch(r, 0, time, Reactions_Type, 0, r.nComp(), r.nGrow());
     }
 
-    ReduceOps<ReduceOpSum> reduce_op;
-    ReduceData<Real> reduce_data(reduce_op);
+    // The reduction counts the failed burns and the burner RHS and
+    // Jacobian evaluations.
+
+    ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum> reduce_op;
+    ReduceData<Real, Real, Real> reduce_data(reduce_op);
     using ReduceTuple = typename decltype(reduce_data)::Type;
 
+    MultiFab* cost = cost_data();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -185,6 +227,8 @@ Castro::react_state(MultiFab& s, MultiFab& r, const iMultiFab& m, Real time, Rea
 
         const Box& bx = mfi.growntilebox(ngrow);
 
+        CostTimer cost_timer(cost, mfi, bx);
+
         auto U = s.array(mfi);
         auto reactions = r.array(mfi);
         auto mask = m.array(mfi);
@@ -315,7 +359,9 @@ Castro::react_state(MultiFab& s, MultiFab& r, const iMultiFab& m, Real time, Rea
 
                                }
 
-                               return {burn_failed};
+                               return {burn_failed,
+                                       static_cast<Real>(burn_state.n_rhs),
+                                       static_cast<Real>(burn_state.n_jac)};
 
                            });
 
@@ -355,6 +401,9 @@ Castro::react_state(MultiFab& s, MultiFab& r, const iMultiFab& m, Real time, Rea
 #ifdef CXX_REACTIONS
     ReduceTuple hv = reduce_data.value();
     Real burn_failed = amrex::get<0>(hv);
+
+    PerfLog::add_burn_counts(static_cast<Long>(amrex::get<1>(hv)),
+                             static_cast<Long>(amrex::get<2>(hv)));
 #endif
 
     if (burn_failed != 0.0) burn_success = 0;
@@ -400,6 +449,8 @@ Castro::react_state(Real time, Real dt)
 {
     BL_PROFILE("Castro::react_state()");
 
+    PerfRegion perf_region(PerfLog::Burn);
+
     // Sanity check: should only be in here if we're doing simplified SDC.
 
     if (time_integration_method != SimplifiedSpectralDeferredCorrections) {
@@ -433,6 +484,8 @@ Castro::react_state(Real time, Real dt)
     int burn_success = 1;
     Real burn_failed = 0.0;
 
+    MultiFab* cost = cost_data();
+
 #ifdef _OPENMP
 #pragma omp parallel reduction(+:burn_failed)
 #endif
@@ -441,6 +494,8 @@ Castro::react_state(Real time, Real dt)
 
         const Box& bx = mfi.growntilebox(ng);
 
+        CostTimer cost_timer(cost, mfi, bx);
+
         FArrayBox& uold    = S_old[mfi];
         FArrayBox& unew    = S_new[mfi];
         FArrayBox& a       = A_src[mfi];
@@ -1,6 +1,7 @@
 
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_cost.H"
 #include "Castro_util.H"
 
 using namespace amrex;
@@ -33,12 +34,17 @@ Castro::construct_old_rotation_source(MultiFab& source, MultiFab& state_in, Real
     const int* domlo = geom.Domain().loVect();
     const int* domhi = geom.Domain().hiVect();
 
+    MultiFab* cost = cost_data();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
     for (MFIter mfi(state_in, TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
         const Box& bx = mfi.tilebox();
+
+        CostTimer cost_timer(cost, mfi, bx);
+
 #pragma gpu box(bx)
         ca_rsrc(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
                 AMREX_INT_ANYD(domlo), AMREX_INT_ANYD(domhi),
@@ -103,6 +109,8 @@ Castro::construct_new_rotation_source(MultiFab& source, MultiFab& state_old, Mul
     const int* domlo = geom.Domain().loVect();
     const int* domhi = geom.Domain().hiVect();
 
+    MultiFab* cost = cost_data();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -111,6 +119,8 @@ Castro::construct_new_rotation_source(MultiFab& source, MultiFab& state_old, Mul
         {
             const Box& bx = mfi.tilebox();
 
+            CostTimer cost_timer(cost, mfi, bx);
+
 #pragma gpu box(bx)
             ca_corrrsrc(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
                         AMREX_INT_ANYD(domlo), AMREX_INT_ANYD(domhi),
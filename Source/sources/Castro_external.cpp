@@ -1,5 +1,6 @@
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_cost.H"
 
 using namespace amrex;
 
@@ -116,6 +117,8 @@ Castro::fill_ext_source (Real time, Real dt, MultiFab& state_old, MultiFab& stat
     const Real* dx = geom.CellSize();
     const Real* prob_lo = geom.ProbLo();
 
+    MultiFab* cost = cost_data();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -124,6 +127,8 @@ Castro::fill_ext_source (Real time, Real dt, MultiFab& state_old, MultiFab& stat
 
         const Box& bx = mfi.tilebox();
 
+        CostTimer cost_timer(cost, mfi, bx);
+
 #pragma gpu box(bx)
         ca_ext_src
           (AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
@@ -0,0 +1,474 @@
+#include "Castro.H"
+#include "Castro_F.H"
+#include "Castro_geometry.H"
+#include "Castro_cost.H"
+
+using namespace amrex;
+
+// The local sources only need the state (and fields that are already
+// filled) in the zone they update, so they can all be evaluated in a
+// single sweep over the tiles, each one adding to the source while the
+// tile is in cache.
+
+bool
+Castro::local_source(int src, bool is_new)
+{
+    switch(src) {
+
+#ifdef GRAVITY
+    case grav_src:
+        return true;
+#endif
+
+#ifdef ROTATION
+    case rot_src:
+        return true;
+#endif
+
+#ifdef SPONGE
+    case sponge_src:
+        // The new-time sponge needs the sponge parameters at both the
+        // old and the new time, so it cannot be done in one sweep.
+        return !is_new;
+#endif
+
+    case ext_src:
+        return true;
+
+    default:
+        return false;
+
+    } // end switch
+}
+
+void
+Castro::add_local_source_buffer(const Box& bx, FArrayBox& buffer, FArrayBox& source,
+                                Real mult_factor, Real dt, Real* diagnostics)
+{
+    Array4<Real const> const buf = buffer.const_array();
+    Array4<Real> const src = source.array();
+
+    AMREX_PARALLEL_FOR_4D(bx, NSRC, i, j, k, n,
+    {
+        src(i,j,k,n) += mult_factor * buf(i,j,k,n);
+    });
+
+    if (diagnostics == nullptr) return;
+
+    // The diagnostics are only for debugging, so they are summed on the
+    // host rather than with a reduction kernel per component.
+
+    Gpu::synchronize();
+
+    const int coord = geom.Coord();
+    const auto dx = geom.CellSizeArray();
+    const auto problo = geom.ProbLoArray();
+
+    const auto lo = lbound(bx);
+    const auto hi = ubound(bx);
+
+    for (int n = 0; n < NSRC; ++n) {
+        for (int k = lo.z; k <= hi.z; ++k) {
+            for (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    diagnostics[n] += mult_factor * buf(i,j,k,n) * cell_volume(i, j, k, coord, dx, problo) * dt;
+                }
+            }
+        }
+    }
+}
+
+void
+Castro::construct_old_local_sources(MultiFab& source, MultiFab& state_in, Real time, Real dt)
+{
+    BL_PROFILE("Castro::construct_old_local_sources()");
+
+    const Real strt_time = ParallelDescriptor::second();
+
+    // First, the work that is not done zone by zone.
+
+#ifdef ROTATION
+    MultiFab& phirot_old = get_old_data(PhiRot_Type);
+    MultiFab& rot_old = get_old_data(Rotation_Type);
+
+    if (do_rotation) {
+        fill_rotation_field(phirot_old, rot_old, state_in, time);
+    } else {
+        phirot_old.setVal(0.0);
+        rot_old.setVal(0.0);
+    }
+#endif
+
+#ifdef SPONGE
+    if (do_sponge) {
+        update_sponge_params(&time);
+    }
+#endif
+
+#ifdef GRAVITY
+    const MultiFab& phi_old = get_old_data(PhiGrav_Type);
+    const MultiFab& grav_old = get_old_data(Gravity_Type);
+#endif
+
+    const bool diagnostics = print_update_diagnostics;
+
+    Vector<Real> source_changes(num_src * NSRC, 0.0);
+
+    const Real* dx = geom.CellSize();
+    const Real* prob_lo = geom.ProbLo();
+    const int* domlo = geom.Domain().loVect();
+    const int* domhi = geom.Domain().hiVect();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        FArrayBox buffer;
+
+        Vector<Real> local_changes(num_src * NSRC, 0.0);
+
+        MultiFab* cost = cost_data();
+
+        for (MFIter mfi(state_in, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+
+            CostTimer cost_timer(cost, mfi, bx);
+
+            buffer.resize(bx, NSRC);
+            Elixir elix_buffer = buffer.elixir();
+            Array4<Real> const buf = buffer.array();
+
+            for (int src = 0; src < num_src; ++src) {
+
+                if (!local_source(src, false) || !source_flag(src)) continue;
+
+                // The external source overwrites its argument, and the
+                // diagnostics need each source on its own, so in those
+                // cases the source goes through the tile buffer.
+                // Otherwise it is added directly.
+
+                const bool buffered = diagnostics || src == ext_src;
+
+                if (buffered) {
+                    AMREX_PARALLEL_FOR_4D(bx, NSRC, i, j, k, n,
+                    {
+                        buf(i,j,k,n) = 0.0;
+                    });
+                }
+
+                FArrayBox& dest = buffered ? buffer : source[mfi];
+
+#ifdef GRAVITY
+                if (src == grav_src) {
+#pragma gpu box(bx)
+                    ca_gsrc(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+                            AMREX_INT_ANYD(domlo), AMREX_INT_ANYD(domhi),
+                            BL_TO_FORTRAN_ANYD(state_in[mfi]),
+                            BL_TO_FORTRAN_ANYD(phi_old[mfi]),
+                            BL_TO_FORTRAN_ANYD(grav_old[mfi]),
+                            BL_TO_FORTRAN_ANYD(dest),
+                            AMREX_REAL_ANYD(dx), dt, time);
+                }
+#endif
+
+#ifdef ROTATION
+                if (src == rot_src) {
+#pragma gpu box(bx)
+                    ca_rsrc(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+                            AMREX_INT_ANYD(domlo), AMREX_INT_ANYD(domhi),
+                            BL_TO_FORTRAN_ANYD(phirot_old[mfi]),
+                            BL_TO_FORTRAN_ANYD(rot_old[mfi]),
+                            BL_TO_FORTRAN_ANYD(state_in[mfi]),
+                            BL_TO_FORTRAN_ANYD(dest),
+                            BL_TO_FORTRAN_ANYD(volume[mfi]),
+                            AMREX_REAL_ANYD(dx), dt, time);
+                }
+#endif
+
+#ifdef SPONGE
+                if (src == sponge_src) {
+                    apply_sponge(bx, state_in.array(mfi), dest.array(), dt, 1.0);
+                }
+#endif
+
+                if (src == ext_src) {
+#pragma gpu box(bx)
+                    ca_ext_src(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+                               BL_TO_FORTRAN_ANYD(state_in[mfi]),
+                               BL_TO_FORTRAN_ANYD(state_in[mfi]),
+                               BL_TO_FORTRAN_ANYD(dest),
+                               AMREX_REAL_ANYD(prob_lo), AMREX_REAL_ANYD(dx), time, dt);
+                }
+
+                if (buffered) {
+                    add_local_source_buffer(bx, buffer, source[mfi], 1.0, dt,
+                                            diagnostics ? &local_changes[src * NSRC] : nullptr);
+                }
+
+            }
+        }
+
+        if (diagnostics) {
+#ifdef _OPENMP
+#pragma omp critical (old_local_source_changes)
+#endif
+            for (int n = 0; n < num_src * NSRC; ++n) {
+                source_changes[n] += local_changes[n];
+            }
+        }
+    }
+
+    if (diagnostics) {
+        print_local_source_changes(source_changes, false);
+    }
+
+    if (verbose > 1)
+    {
+        const int IOProc   = ParallelDescriptor::IOProcessorNumber();
+        Real      run_time = ParallelDescriptor::second() - strt_time;
+
+#ifdef BL_LAZY
+        Lazy::QueueReduction( [=] () mutable {
+#endif
+        ParallelDescriptor::ReduceRealMax(run_time,IOProc);
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "Castro::construct_old_local_sources() time = " << run_time << "\n" << "\n";
+#ifdef BL_LAZY
+        });
+#endif
+    }
+}
+
+void
+Castro::construct_new_local_sources(MultiFab& source, MultiFab& state_old, MultiFab& state_new, Real time, Real dt)
+{
+    BL_PROFILE("Castro::construct_new_local_sources()");
+
+    const Real strt_time = ParallelDescriptor::second();
+
+    // First, the work that is not done zone by zone.
+
+#ifdef ROTATION
+    MultiFab& phirot_old = get_old_data(PhiRot_Type);
+    MultiFab& rot_old = get_old_data(Rotation_Type);
+
+    MultiFab& phirot_new = get_new_data(PhiRot_Type);
+    MultiFab& rot_new = get_new_data(Rotation_Type);
+
+    if (do_rotation) {
+        fill_rotation_field(phirot_new, rot_new, state_new, time);
+    } else {
+        phirot_new.setVal(0.0);
+        rot_new.setVal(0.0);
+    }
+#endif
+
+#ifdef GRAVITY
+    MultiFab& phi_old = get_old_data(PhiGrav_Type);
+    MultiFab& phi_new = get_new_data(PhiGrav_Type);
+
+    MultiFab& grav_old = get_old_data(Gravity_Type);
+    MultiFab& grav_new = get_new_data(Gravity_Type);
+#endif
+
+    // The external source is time centered here, as in
+    // construct_new_ext_source: its old-time value is taken out and
+    // its new-time value put in.
+
+    const Real old_time = time - dt;
+
+    const Real ext_mult_old = ext_src_implicit ? -1.0 : -0.5;
+    const Real ext_mult_new = ext_src_implicit ?  1.0 :  0.5;
+
+    const bool diagnostics = print_update_diagnostics;
+
+    Vector<Real> source_changes(num_src * NSRC, 0.0);
+
+    const Real* dx = geom.CellSize();
+    const Real* prob_lo = geom.ProbLo();
+    const int* domlo = geom.Domain().loVect();
+    const int* domhi = geom.Domain().hiVect();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        FArrayBox buffer;
+
+        Vector<Real> local_changes(num_src * NSRC, 0.0);
+
+        MultiFab* cost = cost_data();
+
+        for (MFIter mfi(state_new, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+
+            CostTimer cost_timer(cost, mfi, bx);
+
+            buffer.resize(bx, NSRC);
+            Elixir elix_buffer = buffer.elixir();
+            Array4<Real> const buf = buffer.array();
+
+            auto zero_buffer = [&] ()
+            {
+                AMREX_PARALLEL_FOR_4D(bx, NSRC, i, j, k, n,
+                {
+                    buf(i,j,k,n) = 0.0;
+                });
+            };
+
+            for (int src = 0; src < num_src; ++src) {
+
+                if (!local_source(src, true) || !source_flag(src)) continue;
+
+                Real* changes = diagnostics ? &local_changes[src * NSRC] : nullptr;
+
+                if (src == ext_src) {
+
+                    zero_buffer();
+
+#pragma gpu box(bx)
+                    ca_ext_src(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+                               BL_TO_FORTRAN_ANYD(state_old[mfi]),
+                               BL_TO_FORTRAN_ANYD(state_old[mfi]),
+                               BL_TO_FORTRAN_ANYD(buffer),
+                               AMREX_REAL_ANYD(prob_lo), AMREX_REAL_ANYD(dx), old_time, dt);
+
+                    add_local_source_buffer(bx, buffer, source[mfi], ext_mult_old, dt, changes);
+
+                    zero_buffer();
+
+#pragma gpu box(bx)
+                    ca_ext_src(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+                               BL_TO_FORTRAN_ANYD(state_old[mfi]),
+                               BL_TO_FORTRAN_ANYD(state_new[mfi]),
+                               BL_TO_FORTRAN_ANYD(buffer),
+                               AMREX_REAL_ANYD(prob_lo), AMREX_REAL_ANYD(dx), time, dt);
+
+                    add_local_source_buffer(bx, buffer, source[mfi], ext_mult_new, dt, changes);
+
+                    continue;
+
+                }
+
+                if (diagnostics) {
+                    zero_buffer();
+                }
+
+                FArrayBox& dest = diagnostics ? buffer : source[mfi];
+
+#ifdef GRAVITY
+                if (src == grav_src) {
+#pragma gpu box(bx)
+                    ca_corrgsrc(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+                                AMREX_INT_ANYD(domlo), AMREX_INT_ANYD(domhi),
+                                BL_TO_FORTRAN_ANYD(state_old[mfi]),
+                                BL_TO_FORTRAN_ANYD(state_new[mfi]),
+                                BL_TO_FORTRAN_ANYD(phi_old[mfi]),
+                                BL_TO_FORTRAN_ANYD(phi_new[mfi]),
+                                BL_TO_FORTRAN_ANYD(grav_old[mfi]),
+                                BL_TO_FORTRAN_ANYD(grav_new[mfi]),
+                                BL_TO_FORTRAN_ANYD(volume[mfi]),
+                                BL_TO_FORTRAN_ANYD((*mass_fluxes[0])[mfi]),
+                                BL_TO_FORTRAN_ANYD((*mass_fluxes[1])[mfi]),
+                                BL_TO_FORTRAN_ANYD((*mass_fluxes[2])[mfi]),
+                                BL_TO_FORTRAN_ANYD(dest),
+                                AMREX_REAL_ANYD(dx), dt, time);
+                }
+#endif
+
+#ifdef ROTATION
+                if (src == rot_src) {
+#pragma gpu box(bx)
+                    ca_corrrsrc(AMREX_INT_ANYD(bx.loVect()), AMREX_INT_ANYD(bx.hiVect()),
+                                AMREX_INT_ANYD(domlo), AMREX_INT_ANYD(domhi),
+                                BL_TO_FORTRAN_ANYD(phirot_old[mfi]),
+                                BL_TO_FORTRAN_ANYD(phirot_new[mfi]),
+                                BL_TO_FORTRAN_ANYD(rot_old[mfi]),
+                                BL_TO_FORTRAN_ANYD(rot_new[mfi]),
+                                BL_TO_FORTRAN_ANYD(state_old[mfi]),
+                                BL_TO_FORTRAN_ANYD(state_new[mfi]),
+                                BL_TO_FORTRAN_ANYD(dest),
+                                BL_TO_FORTRAN_ANYD((*mass_fluxes[0])[mfi]),
+                                BL_TO_FORTRAN_ANYD((*mass_fluxes[1])[mfi]),
+                                BL_TO_FORTRAN_ANYD((*mass_fluxes[2])[mfi]),
+                                AMREX_REAL_ANYD(dx), dt, time,
+                                BL_TO_FORTRAN_ANYD(volume[mfi]));
+                }
+#endif
+
+                if (diagnostics) {
+                    add_local_source_buffer(bx, buffer, source[mfi], 1.0, dt, changes);
+                }
+
+            }
+        }
+
+        if (diagnostics) {
+#ifdef _OPENMP
+#pragma omp critical (new_local_source_changes)
+#endif
+            for (int n = 0; n < num_src * NSRC; ++n) {
+                source_changes[n] += local_changes[n];
+            }
+        }
+    }
+
+    if (diagnostics) {
+        print_local_source_changes(source_changes, true);
+    }
+
+    if (verbose > 1)
+    {
+        const int IOProc   = ParallelDescriptor::IOProcessorNumber();
+        Real      run_time = ParallelDescriptor::second() - strt_time;
+
+#ifdef BL_LAZY
+        Lazy::QueueReduction( [=] () mutable {
+#endif
+        ParallelDescriptor::ReduceRealMax(run_time,IOProc);
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "Castro::construct_new_local_sources() time = " << run_time << "\n" << "\n";
+#ifdef BL_LAZY
+        });
+#endif
+    }
+}
+
+void
+Castro::print_local_source_changes(Vector<Real> source_changes, bool is_new)
+{
+    // source_changes holds the volume-weighted change from each source,
+    // NSRC components per source, summed on this rank.
+
+#ifdef BL_LAZY
+    Lazy::QueueReduction( [=] () mutable {
+#endif
+
+    ParallelDescriptor::ReduceRealSum(source_changes.dataPtr(), source_changes.size(),
+                                      ParallelDescriptor::IOProcessorNumber());
+
+    std::string time = is_new ? "new" : "old";
+
+    for (int src = 0; src < num_src; ++src) {
+
+        if (!local_source(src, is_new) || !source_flag(src)) continue;
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << std::endl << "  Contributions to the state from the " << time << "-time "
+                      << source_names[src] << " source:" << std::endl;
+
+        Vector<Real> update(source_changes.begin() + src * NSRC,
+                            source_changes.begin() + (src + 1) * NSRC);
+
+        print_source_change(update);
+
+    }
+
+#ifdef BL_LAZY
+    });
+#endif
+}
@@ -1,5 +1,7 @@
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_geometry.H"
+#include "Castro_perf_log.H"
 
 #ifdef RADIATION
 #include "Radiation.H"
@@ -8,14 +10,20 @@
 using namespace amrex;
 
 void
-Castro::apply_source_to_state(MultiFab& target_state, MultiFab& source, Real dt, int ng)
+Castro::apply_source_to_state(MultiFab& target_state, MultiFab& source, Real dt, int ng, bool sparse)
 {
     BL_PROFILE("Castro::apply_source_to_state()");
 
     AMREX_ASSERT(source.nGrow() >= ng);
     AMREX_ASSERT(target_state.nGrow() >= ng);
 
-    MultiFab::Saxpy(target_state, dt, source, 0, 0, source.nComp(), ng);
+    if (sparse) {
+        for (const auto& range : source_component_ranges()) {
+            MultiFab::Saxpy(target_state, dt, source, range.first, range.first, range.second, ng);
+        }
+    } else {
+        MultiFab::Saxpy(target_state, dt, source, 0, 0, source.nComp(), ng);
+    }
 }
 
 void
@@ -92,12 +100,117 @@ Castro::source_flag(int src)
     } // end switch
 }
 
+void
+Castro::source_components(int src, Vector<int>& used)
+{
+    AMREX_ASSERT(used.size() == NSRC);
+
+    // These should list every component that the source kernels
+    // can write to; a component that is left out is dropped from the
+    // update when sparse_source_components is on.
+
+    switch(src) {
+
+#ifdef SPONGE
+    case sponge_src:
+#endif
+#ifdef GRAVITY
+    case grav_src:
+#endif
+#ifdef ROTATION
+    case rot_src:
+#endif
+        for (int n = UMX; n <= UMZ; ++n) {
+            used[n] = 1;
+        }
+#ifdef HYBRID_MOMENTUM
+        for (int n = UMR; n <= UMP; ++n) {
+            used[n] = 1;
+        }
+#endif
+        used[UEDEN] = 1;
+        break;
+
+    case thermo_src:
+        used[UEINT] = 1;
+        break;
+
+#ifdef DIFFUSION
+    case diff_src:
+        used[UEDEN] = 1;
+        used[UEINT] = 1;
+        break;
+#endif
+
+#ifdef HYBRID_MOMENTUM
+    case hybrid_src:
+        for (int n = UMR; n <= UMP; ++n) {
+            used[n] = 1;
+        }
+        break;
+#endif
+
+    default:
+        // The external source is user code and may change anything.
+        for (int n = 0; n < NSRC; ++n) {
+            used[n] = 1;
+        }
+        break;
+
+    } // end switch
+}
+
+const Vector<std::pair<int, int>>&
+Castro::source_component_ranges()
+{
+    // The active sources are fixed for the whole run, so this is
+    // only worked out once.
+
+    static Vector<std::pair<int, int>> ranges;
+    static bool initialized = false;
+
+    if (initialized) {
+        return ranges;
+    }
+
+    Vector<int> used(NSRC, 0);
+
+    if (sparse_source_components) {
+        for (int src = 0; src < num_src; ++src) {
+            if (source_flag(src)) {
+                source_components(src, used);
+            }
+        }
+    } else {
+        for (int n = 0; n < NSRC; ++n) {
+            used[n] = 1;
+        }
+    }
+
+    // Merge the components into contiguous (start, count) ranges.
+
+    for (int n = 0; n < NSRC; ++n) {
+        if (!used[n]) continue;
+        if (!ranges.empty() && ranges.back().first + ranges.back().second == n) {
+            ranges.back().second += 1;
+        } else {
+            ranges.push_back(std::make_pair(n, 1));
+        }
+    }
+
+    initialized = true;
+
+    return ranges;
+}
+
 void
 Castro::do_old_sources(MultiFab& source, MultiFab& state_old, MultiFab& state_new, Real time, Real dt, bool apply_to_state, int amr_iteration, int amr_ncycle)
 {
 
     BL_PROFILE("Castro::do_old_sources()");
 
+    PerfRegion perf_region(PerfLog::Sources);
+
     const Real strt_time = ParallelDescriptor::second();
 
     // Construct the old-time sources.
@@ -107,11 +220,19 @@ Castro::do_old_sources(MultiFab& source, MultiFab& state_old, MultiFab& state_ne
     MultiFab temp_source;
 
     if (apply_sources_consecutively && apply_to_state) {
-        temp_source.define(grids, dmap, NSRC, NUM_GROW);
+        buffer_pool.define(temp_source, "temp_source", grids, dmap, NSRC, NUM_GROW);
         temp_source.setVal(0.0, NUM_GROW);
     }
 
+    // The local sources can be evaluated together, after the others,
+    // unless they are being applied one at a time.
+
+    const bool fuse_local = fuse_local_sources && !(apply_sources_consecutively && apply_to_state);
+
     for (int n = 0; n < num_src; ++n) {
+
+        if (fuse_local && local_source(n, false)) continue;
+
         construct_old_source(n, source, state_old, time, dt, amr_iteration, amr_ncycle);
 
         // We can either apply the sources to the state one by one, or we can
@@ -119,14 +240,16 @@ Castro::do_old_sources(MultiFab& source, MultiFab& state_old, MultiFab& state_ne
 
         if (apply_sources_consecutively && apply_to_state) {
 
-            apply_source_to_state(state_new, source, dt, 0);
+            apply_source_to_state(state_new, source, dt, 0, true);
             clean_state(state_new, time + dt, 0);
 
             // Zero out the source MultiFab for the next source term.
             // Also, log the sum of all source terms since we need
             // to save that after we're done.
 
-            MultiFab::Add(temp_source, source, 0, 0, NSRC, NUM_GROW);
+            for (const auto& range : source_component_ranges()) {
+                MultiFab::Add(temp_source, source, range.first, range.first, range.second, NUM_GROW);
+            }
 
             if (n < num_src - 1) {
                 source.setVal(0.0, NUM_GROW);
@@ -136,12 +259,17 @@ Castro::do_old_sources(MultiFab& source, MultiFab& state_old, MultiFab& state_ne
 
     }
 
+    if (fuse_local) {
+        construct_old_local_sources(source, state_old, time, dt);
+    }
+
     if (apply_to_state) {
 
         if (apply_sources_consecutively) {
             MultiFab::Copy(source, temp_source, 0, 0, NSRC, NUM_GROW);
+            buffer_pool.release(temp_source, "temp_source");
         } else {
-            apply_source_to_state(state_new, source, dt, 0);
+            apply_source_to_state(state_new, source, dt, 0, true);
             clean_state(state_new, time, 0);
         }
 
@@ -180,6 +308,8 @@ Castro::do_new_sources(MultiFab& source, MultiFab& state_old, MultiFab& state_ne
 
     BL_PROFILE("Castro::do_new_sources()");
 
+    PerfRegion perf_region(PerfLog::Sources);
+
     const Real strt_time = ParallelDescriptor::second();
 
     source.setVal(0.0, NUM_GROW);
@@ -187,13 +317,18 @@ Castro::do_new_sources(MultiFab& source, MultiFab& state_old, MultiFab& state_ne
     MultiFab temp_source;
 
     if (apply_sources_consecutively && apply_to_state) {
-        temp_source.define(grids, dmap, NSRC, NUM_GROW);
+        buffer_pool.define(temp_source, "temp_source", grids, dmap, NSRC, NUM_GROW);
         temp_source.setVal(0.0, NUM_GROW);
     }
 
     // Construct the new-time source terms.
 
+    const bool fuse_local = fuse_local_sources && !(apply_sources_consecutively && apply_to_state);
+
     for (int n = 0; n < num_src; ++n) {
+
+        if (fuse_local && local_source(n, true)) continue;
+
         construct_new_source(n, source, state_old, state_new, time, dt, amr_iteration, amr_ncycle);
 
         // We can either apply the sources to the state one by one, or we can
@@ -206,14 +341,16 @@ Castro::do_new_sources(MultiFab& source, MultiFab& state_old, MultiFab& state_ne
 
             AmrLevel::FillPatch(*this, source, NUM_GROW, time, Source_Type, 0, source.nComp());
 
-            apply_source_to_state(state_new, source, dt, 0);
+            apply_source_to_state(state_new, source, dt, 0, true);
             clean_state(state_new, time, 0);
 
             // Zero out the source MultiFab for the next source term.
             // Also, log the sum of all source terms since we need
             // to save that after we're done.
 
-            MultiFab::Add(temp_source, source, 0, 0, NSRC, NUM_GROW);
+            for (const auto& range : source_component_ranges()) {
+                MultiFab::Add(temp_source, source, range.first, range.first, range.second, NUM_GROW);
+            }
 
             if (n < num_src - 1) {
                 source.setVal(0.0, NUM_GROW);
@@ -223,12 +360,17 @@ Castro::do_new_sources(MultiFab& source, MultiFab& state_old, MultiFab& state_ne
 
     }
 
+    if (fuse_local) {
+        construct_new_local_sources(source, state_old, state_new, time, dt);
+    }
+
     if (apply_to_state) {
 
         if (apply_sources_consecutively) {
             MultiFab::Copy(source, temp_source, 0, 0, NSRC, NUM_GROW);
+            buffer_pool.release(temp_source, "temp_source");
         } else {
-            apply_source_to_state(state_new, source, dt, 0);
+            apply_source_to_state(state_new, source, dt, 0, true);
             clean_state(state_new, time, 0);
         }
 
@@ -397,23 +539,46 @@ Castro::evaluate_source_change(MultiFab& source, Real dt, bool local)
     
   Vector<Real> update(source.nComp(), 0.0);
 
-  // Create a temporary array which will hold a single component
-  // at a time of the volume-weighted source.
+  // Sum source x volume over the valid zones, one component at a time.
+  // The zone volume is computed analytically rather than read from the
+  // stored volume MultiFab.
 
-  MultiFab weighted_source(source.boxArray(), source.DistributionMap(), 1, 0);
+  const int coord = geom.Coord();
+  const auto dx = geom.CellSizeArray();
+  const auto problo = geom.ProbLoArray();
 
   for (int n = 0; n < source.nComp(); ++n) {
 
-    weighted_source.setVal(0.0);
+    ReduceOps<ReduceOpSum> reduce_op;
+    ReduceData<Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
 
-    // Fill weighted_source with source x volume.
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(source, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+      const Box& bx = mfi.tilebox();
+
+      auto const src = source.array(mfi);
 
-    MultiFab::AddProduct(weighted_source, source, n, volume, 0, 0, 1, 0);
+      reduce_op.eval(bx, reduce_data,
+      [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) noexcept -> ReduceTuple
+      {
+        return {src(i,j,k,n) * cell_volume(i, j, k, coord, dx, problo)};
+      });
 
-    update[n] = weighted_source.sum(0, local) * dt;
+    }
+
+    ReduceTuple hv = reduce_data.value();
+    update[n] = amrex::get<0>(hv) * dt;
 
   }
 
+  if (!local) {
+    ParallelDescriptor::ReduceRealSum(update.dataPtr(), update.size());
+  }
+
   return update;
 
 }
@@ -502,11 +667,20 @@ Castro::sum_of_sources(MultiFab& source)
   MultiFab& old_sources = get_old_data(Source_Type);
   MultiFab& new_sources = get_new_data(Source_Type);
 
-  MultiFab::Add(source, old_sources, 0, 0, old_sources.nComp(), ng);
+  // The components of the sources that no active source writes to
+  // are zero, so they are skipped.
+
+  const auto& ranges = source_component_ranges();
+
+  for (const auto& range : ranges) {
+      MultiFab::Add(source, old_sources, range.first, range.first, range.second, ng);
+  }
 
   MultiFab::Add(source, hydro_source, 0, 0, NUM_STATE, ng);
 
-  MultiFab::Add(source, new_sources, 0, 0, new_sources.nComp(), ng);
+  for (const auto& range : ranges) {
+      MultiFab::Add(source, new_sources, range.first, range.first, range.second, ng);
+  }
 
 }
 
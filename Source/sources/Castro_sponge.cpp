@@ -1,6 +1,7 @@
 #ifdef SPONGE
 #include "Castro.H"
 #include "Castro_F.H"
+#include "Castro_cost.H"
 
 #ifdef HYBRID_MOMENTUM
 #include "hybrid.H"
@@ -19,6 +20,8 @@ Castro::construct_old_sponge_source(MultiFab& source, MultiFab& state_in, Real t
 
     const Real mult_factor = 1.0;
 
+    MultiFab* cost = cost_data();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -26,6 +29,8 @@ Castro::construct_old_sponge_source(MultiFab& source, MultiFab& state_in, Real t
     {
         const Box& bx = mfi.tilebox();
 
+        CostTimer cost_timer(cost, mfi, bx);
+
         apply_sponge(bx, state_in.array(mfi), source.array(mfi), dt, mult_factor);
 
     }
@@ -62,6 +67,8 @@ Castro::construct_new_sponge_source(MultiFab& source, MultiFab& state_old, Multi
     // Note that the sponge parameters are still current
     // at this point from their evaluation at the old time.
 
+    MultiFab* cost = cost_data();
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -69,6 +76,8 @@ Castro::construct_new_sponge_source(MultiFab& source, MultiFab& state_old, Multi
     {
         const Box& bx = mfi.tilebox();
 
+        CostTimer cost_timer(cost, mfi, bx);
+
         apply_sponge(bx, state_old.array(mfi), source.array(mfi), dt, mult_factor_old);
     }
 
@@ -84,6 +93,8 @@ Castro::construct_new_sponge_source(MultiFab& source, MultiFab& state_old, Multi
     {
         const Box& bx = mfi.tilebox();
 
+        CostTimer cost_timer(cost, mfi, bx);
+
         apply_sponge(bx, state_new.array(mfi), source.array(mfi), dt, mult_factor_new);
 
     }
@@ -18,7 +18,9 @@ Castro::construct_old_thermo_source(MultiFab& source, MultiFab& state_in, Real t
 
   Real mult_factor = 1.0;
 
-  MultiFab::Saxpy(source, mult_factor, thermo_src, 0, 0, source.nComp(), 0);
+  // Only the internal energy has a thermodynamic source.
+
+  MultiFab::Saxpy(source, mult_factor, thermo_src, UEINT, UEINT, 1, 0);
 
   if (verbose > 1)
   {
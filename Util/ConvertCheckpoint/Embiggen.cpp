@@ -1,16 +1,22 @@
 
 // This is the version that reads a Checkpoint file
 // and writes it out again.
+//
+// The data are never held in memory a level at a time: each rank streams
+// its share of the FABs from the old checkpoint to the new one, one FAB
+// at a time, so the conversion is a single parallel pass over the data.
 // ---------------------------------------------------------------
 #include <iomanip>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
 #include <vector>
 #include <string>
+#include <memory>
 
 #ifndef WIN32
 #include <unistd.h>
@@ -55,16 +61,17 @@ std::string CheckFileOut;
 int nFiles(64);
 bool verbose(true);
 int num_new_levels(1);
-int      ref_ratio(1);
+Vector<int> ref_ratio;          // one entry per new level, coarsest first
 int   grown_factor(1);
 int star_at_center(-1);
 int   max_grid_size(4096);
 int   coord(-1);
+int   drop_levels(0);
 const std::string CheckPointVersion = "CheckPointVersion_1.0";
 
 Vector<int> nsets_save(1);
 
-VisMF::How how = VisMF::OneFilePerCPU;
+Long bytes_written(0);
 
 
 // ---------------------------------------------------------------
@@ -77,8 +84,10 @@ struct FakeStateData {
     BoxArray grids;
     TimeInterval new_time;
     TimeInterval old_time;
-    MultiFab *new_data;
-    MultiFab *old_data;
+    // Full path of the new and old MultiFabs in the input checkpoint.
+    // These are empty for the new levels, whose data are generated.
+    std::string new_file;
+    std::string old_file;
     Vector< Vector<BCRec> > bc;
 };
 
@@ -89,6 +98,9 @@ struct FakeAmrLevel {
     BoxArray grids;                   // Cell-centered locations of grids.
     IntVect crse_ratio;               // Refinement ratio to coarser level.
     IntVect fine_ratio;               // Refinement ratio to finer level.
+    IntVect shift;                    // Shift applied to the input boxes.
+    int avg_ratio;                    // For new levels other than 0, the ratio
+                                      //   to the old level 0 they average.
     Vector<FakeStateData> state;       // Array of state data.
     Vector<FakeStateData> new_state;   // Array of new state data.
 };
@@ -126,26 +138,50 @@ static void ScanArguments() {
     if(pp.contains("verbose")) {
       pp.get("verbose", verbose);
     }
+    if(pp.contains("num_new_levels")) {
+      pp.get("num_new_levels", num_new_levels);
+    }
     if(pp.contains("ref_ratio")) {
-      pp.get("ref_ratio", ref_ratio);
+      pp.getarr("ref_ratio", ref_ratio);
     }
 
     if(pp.contains("grown_factor")) {
       pp.get("grown_factor", grown_factor);
     }
 
+    if(pp.contains("drop_levels")) {
+      pp.get("drop_levels", drop_levels);
+    }
+
     pp.get("star_at_center", star_at_center);
 
     if (star_at_center != 0 && star_at_center != 1)
        amrex::Abort("star_at_center must be 0 or 1");
 
-    if (ref_ratio != 2 && ref_ratio != 4)
-       amrex::Abort("ref_ratio must be 2 or 4");
+    if (num_new_levels < 1)
+       amrex::Abort("must have num_new_levels >= 1");
+
+    // A single ref_ratio applies to every new level.
+    if (ref_ratio.size() == 1)
+       ref_ratio.resize(num_new_levels, ref_ratio[0]);
 
-    if (grown_factor <= 1)  
+    if (ref_ratio.size() != num_new_levels)
+       amrex::Abort("must give either one ref_ratio or one for each new level");
+
+    for (int i = 0; i < num_new_levels; i++)
+       if (ref_ratio[i] != 2 && ref_ratio[i] != 4)
+          amrex::Abort("ref_ratio must be 2 or 4");
+
+    if (grown_factor <= 1)
         amrex::Abort("must have grown_factor > 1");
 
-    if (star_at_center == 1)  
+    if (drop_levels < 0)
+        amrex::Abort("must have drop_levels >= 0");
+
+    if (nFiles < 1)
+        amrex::Abort("must have nfiles >= 1");
+
+    if (star_at_center == 1)
        if (grown_factor != 2 && grown_factor != 3)
           amrex::Abort("must have grown_factor = 2 or 3 for star at center");
 }
@@ -153,10 +189,12 @@ static void ScanArguments() {
 // ---------------------------------------------------------------
 static void PrintUsage (char *progName) {
     cout << "Usage: " << progName << " checkin=filename "
-         << "checkout=outfilename "  
-         << "ref_ratio= 2 or 4 "   
-         << "grown_factor=integer "   
-         << "star_at_center =0 or 1  "   
+         << "checkout=outfilename "
+         << "ref_ratio= 2 or 4 (one value, or one per new level) "
+         << "grown_factor=integer "
+         << "star_at_center =0 or 1  "
+         << "[num_new_levels=integer] "
+         << "[drop_levels=integer] "
          << "[nfiles=nfilesout] "
          << "[verbose=trueorfalse]" << endl;
     exit(1);
@@ -164,6 +202,258 @@ static void PrintUsage (char *progName) {
 
 // ---------------------------------------------------------------
 
+// Read the header of a MultiFab on the I/O processor and broadcast it.
+
+static void ReadMultiFabHeader(const std::string& mf_name, VisMF::Header& hdr) {
+    Vector<char> fileCharPtr;
+    ParallelDescriptor::ReadAndBcastFile(mf_name + "_H", fileCharPtr);
+    std::string fileCharPtrString(fileCharPtr.dataPtr());
+    std::istringstream is(fileCharPtrString, std::istringstream::in);
+
+    is >> hdr;
+
+    if (hdr.m_vers != VisMF::Header::Version_v1) {
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << mf_name << " has VisMF header version " << hdr.m_vers << std::endl;
+        amrex::Abort("Embiggen can only stream MultiFabs written with VisMF header version 1");
+    }
+}
+
+// ---------------------------------------------------------------
+
+// Reads individual FABs of a MultiFab in the input checkpoint directly
+// from its data files.
+
+class StreamedMultiFabReader {
+public:
+    explicit StreamedMultiFabReader(const std::string& mf_name_)
+        : mf_name(mf_name_)
+    {
+        ReadMultiFabHeader(mf_name, hdr);
+    }
+
+    const VisMF::Header& header() const { return hdr; }
+
+    int nComp() const { return hdr.m_ncomp; }
+    int nGrow() const { return hdr.m_ngrow[0]; }
+
+    void read(int idx, FArrayBox& fab) {
+        const VisMF::FabOnDisk& fod = hdr.m_fod[idx];
+        const std::string file_name = VisMF::DirName(mf_name) + fod.m_name;
+
+        if (file_name != current_file) {
+            if (is.is_open()) is.close();
+            is.open(file_name.c_str(), std::ios::in | std::ios::binary);
+            if( ! is.good()) {
+              amrex::FileOpenFailed(file_name);
+            }
+            current_file = file_name;
+        }
+
+        is.seekg(fod.m_head, std::ios::beg);
+        fab.readFrom(is);
+
+        if( ! is.good()) {
+          amrex::Error("error reading " + file_name);
+        }
+    }
+
+private:
+    std::string mf_name;
+    VisMF::Header hdr;
+    std::ifstream is;
+    std::string current_file;
+};
+
+// ---------------------------------------------------------------
+
+// Writes a MultiFab in the VisMF format one FAB at a time. Every rank
+// writes the FABs it owns under dm, in order, into one of nfiles data
+// files. The byte count of each FAB is known in advance, so each rank
+// can compute where its FABs go and all ranks sharing a file write to
+// it at the same time.
+
+class StreamedMultiFabWriter {
+public:
+    StreamedMultiFabWriter(const std::string& mf_name_, const BoxArray& ba_,
+                           const DistributionMapping& dm_, int ncomp_, int ngrow_)
+        : mf_name(mf_name_), ba(ba_), dm(dm_), ncomp(ncomp_), ngrow(ngrow_),
+          offsets(ba_.size(), 0), fab_min(ba_.size() * ncomp_, 0.0), fab_max(ba_.size() * ncomp_, 0.0)
+    {
+        const int nprocs = ParallelDescriptor::NProcs();
+        const int myproc = ParallelDescriptor::MyProc();
+        const int nfiles = std::min(nFiles, nprocs);
+
+        // Ranks are assigned to files in contiguous groups.
+        auto file_of = [=] (int proc) { return static_cast<int>((static_cast<Long>(proc) * nfiles) / nprocs); };
+
+        my_file = file_of(myproc);
+
+        Vector<Long> rank_bytes(nprocs, 0);
+
+        for (int i = 0; i < ba.size(); i++) {
+            if (dm[i] != myproc) continue;
+            const Box bx = amrex::grow(ba[i], ngrow);
+            FArrayBox hfab(bx, ncomp, false);
+            std::stringstream hss;
+            FArrayBox::getFABio().write_header(hss, hfab, ncomp);
+            offsets[i] = rank_bytes[myproc];
+            rank_bytes[myproc] += static_cast<Long>(hss.str().size()) + bx.numPts() * ncomp * static_cast<Long>(sizeof(Real));
+        }
+
+        ParallelDescriptor::ReduceLongSum(rank_bytes.dataPtr(), nprocs);
+
+        Long base = 0;
+        for (int p = 0; p < myproc; p++) {
+            if (file_of(p) == my_file) base += rank_bytes[p];
+        }
+
+        for (int i = 0; i < ba.size(); i++) {
+            if (dm[i] == myproc) offsets[i] += base;
+        }
+
+        local_bytes = rank_bytes[myproc];
+
+        const std::string data_name = amrex::Concatenate(mf_name + "_D_", my_file, 5);
+
+        // The first rank in each group creates the file.
+        if (myproc == 0 || file_of(myproc - 1) != my_file) {
+            std::ofstream create(data_name.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+            if( ! create.good()) {
+              amrex::FileOpenFailed(data_name);
+            }
+        }
+
+        ParallelDescriptor::Barrier();
+
+        if (local_bytes > 0) {
+            os.open(data_name.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+            if( ! os.good()) {
+              amrex::FileOpenFailed(data_name);
+            }
+        }
+    }
+
+    void write(int idx, const FArrayBox& fab) {
+        BL_ASSERT(dm[idx] == ParallelDescriptor::MyProc());
+        BL_ASSERT(fab.box() == amrex::grow(ba[idx], ngrow));
+        BL_ASSERT(fab.nComp() == ncomp);
+
+        os.seekp(offsets[idx], std::ios::beg);
+        FArrayBox::getFABio().write_header(os, fab, ncomp);
+        os.write(reinterpret_cast<const char*>(fab.dataPtr()), fab.box().numPts() * ncomp * sizeof(Real));
+
+        for (int n = 0; n < ncomp; n++) {
+            fab_min[idx * ncomp + n] = fab.min(ba[idx], n);
+            fab_max[idx * ncomp + n] = fab.max(ba[idx], n);
+        }
+    }
+
+    // Collective: complete the data files and write the header.
+    void finish() {
+        if (os.is_open()) {
+            os.flush();
+            if( ! os.good()) {
+              amrex::Error("error writing " + mf_name);
+            }
+            os.close();
+        }
+
+        bytes_written += local_bytes;
+
+        const int ioproc = ParallelDescriptor::IOProcessorNumber();
+
+        // Every FAB is owned by exactly one rank, so sums assemble the lists.
+        ParallelDescriptor::ReduceLongSum(offsets.dataPtr(), offsets.size(), ioproc);
+        ParallelDescriptor::ReduceRealSum(fab_min.dataPtr(), fab_min.size(), ioproc);
+        ParallelDescriptor::ReduceRealSum(fab_max.dataPtr(), fab_max.size(), ioproc);
+
+        if (ParallelDescriptor::IOProcessor()) {
+            const int nprocs = ParallelDescriptor::NProcs();
+            const int nfiles = std::min(nFiles, nprocs);
+            const std::string base_name = VisMF::BaseName(mf_name);
+
+            VisMF::Header hdr;
+            hdr.m_vers  = VisMF::Header::Version_v1;
+            hdr.m_how   = VisMF::NFiles;
+            hdr.m_ncomp = ncomp;
+            hdr.m_ngrow = IntVect(AMREX_D_DECL(ngrow, ngrow, ngrow));
+            hdr.m_ba    = ba;
+            hdr.m_fod.resize(ba.size());
+            hdr.m_min.resize(ba.size());
+            hdr.m_max.resize(ba.size());
+
+            for (int i = 0; i < ba.size(); i++) {
+                const int file = static_cast<int>((static_cast<Long>(dm[i]) * nfiles) / nprocs);
+                hdr.m_fod[i] = VisMF::FabOnDisk(amrex::Concatenate(base_name + "_D_", file, 5), offsets[i]);
+                hdr.m_min[i].resize(ncomp);
+                hdr.m_max[i].resize(ncomp);
+                for (int n = 0; n < ncomp; n++) {
+                    hdr.m_min[i][n] = fab_min[i * ncomp + n];
+                    hdr.m_max[i][n] = fab_max[i * ncomp + n];
+                }
+            }
+
+            const std::string hdr_name = mf_name + "_H";
+            std::ofstream hdr_file(hdr_name.c_str(), std::ios::out | std::ios::trunc);
+            if( ! hdr_file.good()) {
+              amrex::FileOpenFailed(hdr_name);
+            }
+            hdr_file << hdr;
+            hdr_file.close();
+        }
+    }
+
+private:
+    std::string mf_name;
+    BoxArray ba;
+    DistributionMapping dm;
+    int ncomp;
+    int ngrow;
+    int my_file;
+    Long local_bytes;
+    Vector<Long> offsets;
+    Vector<Real> fab_min;
+    Vector<Real> fab_max;
+    std::fstream os;
+};
+
+// ---------------------------------------------------------------
+
+// Average the fine data onto the valid region of crse.
+
+static void AverageDown(const FArrayBox& fine, FArrayBox& crse, const Box& crse_valid, int ratio) {
+    const int ncomp = crse.nComp();
+    const Real volfrac = 1.0 / std::pow(static_cast<Real>(ratio), BL_SPACEDIM);
+
+    const int rx = ratio;
+    const int ry = AMREX_D_PICK(1, ratio, ratio);
+    const int rz = AMREX_D_PICK(1, 1, ratio);
+
+    const auto f = fine.array();
+    const auto c = crse.array();
+
+    const Dim3 lo = amrex::lbound(crse_valid);
+    const Dim3 hi = amrex::ubound(crse_valid);
+
+    for (int n = 0; n < ncomp; n++) {
+      for (int k = lo.z; k <= hi.z; k++) {
+        for (int j = lo.y; j <= hi.y; j++) {
+          for (int i = lo.x; i <= hi.x; i++) {
+            Real sum = 0.0;
+            for (int kk = 0; kk < rz; kk++)
+              for (int jj = 0; jj < ry; jj++)
+                for (int ii = 0; ii < rx; ii++)
+                  sum += f(rx*i+ii, ry*j+jj, rz*k+kk, n);
+            c(i,j,k,n) = sum * volfrac;
+          }
+        }
+      }
+    }
+}
+
+// ---------------------------------------------------------------
+
 static void ReadCheckpointFile(const std::string& fileName) {
     int i;
     std::string File = fileName;
@@ -171,14 +461,12 @@ static void ReadCheckpointFile(const std::string& fileName) {
     File += '/';
     File += "Header";
 
-    VisMF::IO_Buffer io_buffer(VisMF::IO_Buffer_Size);
+    // The I/O processor reads the header and broadcasts it.
 
-    std::ifstream is;
-    is.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
-    is.open(File.c_str(), std::ios::in);
-    if( ! is.good()) {
-        amrex::FileOpenFailed(File);
-    }
+    Vector<char> fileCharPtr;
+    ParallelDescriptor::ReadAndBcastFile(File, fileCharPtr);
+    std::string fileCharPtrString(fileCharPtr.dataPtr());
+    std::istringstream is(fileCharPtrString, std::istringstream::in);
 
     //
     // Read global data.
@@ -208,16 +496,19 @@ static void ReadCheckpointFile(const std::string& fileName) {
     is >> mx_lev;
     is >> fakeAmr.finest_level;
 
-    if(ParallelDescriptor::IOProcessor()) 
+    if(ParallelDescriptor::IOProcessor())
        std::cout << "previous finest_lev is " << fakeAmr.finest_level <<  std::endl;
 
-    // ADDING LEVELS 
+    if (drop_levels > fakeAmr.finest_level)
+       amrex::Abort("drop_levels cannot be larger than the old finest level");
+
+    // ADDING LEVELS
     int n = num_new_levels;
     mx_lev = mx_lev + n;
     fakeAmr.finest_level = fakeAmr.finest_level + n;
 
     if(ParallelDescriptor::IOProcessor()) {
-       std::cout << "     new finest_lev is " << fakeAmr.finest_level << std::endl;
+       std::cout << "     new finest_lev is " << fakeAmr.finest_level - drop_levels << std::endl;
        std::cout << "previous     mx_lev is " << mx_lev-n << std::endl;
        std::cout << "     new     mx_lev is " << mx_lev << std::endl;
     }
@@ -238,94 +529,100 @@ static void ReadCheckpointFile(const std::string& fileName) {
 
     if(ParallelDescriptor::IOProcessor()) {
        std::cout << " " << std::endl;
-       for (i = 1; i <= mx_lev; i++) {
-          std::cout << "Old checkpoint level    " << i-1 << std::endl;
+       for (i = n; i <= mx_lev; i++) {
+          std::cout << "Old checkpoint level    " << i-n << std::endl;
           std::cout << " ... domain is       " << fakeAmr.geom[i].Domain() << std::endl;
           std::cout << " ...     dx is       " << fakeAmr.geom[i].CellSize()[0] << std::endl;
           std::cout << "  " << std::endl;
        }
     }
 
-    // Make sure current domain is divisible by 2*ref_ratio so length of coarsened domain is even
-    Box dom0(fakeAmr.geom[0].Domain());
+    // Make sure the old level 0 domain is divisible by 2 * (the total
+    // ratio to the new level 0) so length of coarsened domain is even
+    int total_ratio = 1;
+    for (i = 0; i < n; i++) total_ratio *= ref_ratio[i];
+
+    Box dom0(fakeAmr.geom[n].Domain());
     for (int d = 0; d < BL_SPACEDIM; d++)
     {
       int dlen = dom0.size()[d];
-      int scaled = dlen / (2*ref_ratio);
-      if ( (scaled * 2 * ref_ratio) != dlen )
-        amrex::Abort("must have domain divisible by 2*ref_ratio");
+      int scaled = dlen / (2*total_ratio);
+      if ( (scaled * 2 * total_ratio) != dlen )
+        amrex::Abort("must have domain divisible by 2*(product of ref_ratio)");
     }
 
-    if (grown_factor <= 1)  
-        amrex::Abort("must have grown_factor > 1");
-
-    for (i = 1; i <  mx_lev; i++) {
+    for (i = n; i <  mx_lev; i++) {
       is >> fakeAmr.ref_ratio[i];
     }
-    for (i = 1; i <= mx_lev; i++) {
+    for (i = n; i <= mx_lev; i++) {
       is >> fakeAmr.dt_level[i];
     }
 
-    Box          domain(fakeAmr.geom[1].Domain());
-    RealBox prob_domain(fakeAmr.geom[1].ProbDomain());
-    coord = fakeAmr.geom[1].Coord();
+    RealBox prob_domain(fakeAmr.geom[n].ProbDomain());
+    coord = fakeAmr.geom[n].Coord();
 
-    // Define domain for new levels
-    domain.coarsen(ref_ratio);
-    fakeAmr.geom[0].define(domain,&prob_domain,coord);
+    // Define domain, ref_ratio and dt_level for new levels
+    for (int lev = n-1; lev >= 0; lev--) {
+      Box domain(amrex::coarsen(fakeAmr.geom[lev+1].Domain(), ref_ratio[lev]));
+      fakeAmr.geom[lev].define(domain,&prob_domain,coord);
 
-    // Define ref_ratio for new levels
-    fakeAmr.ref_ratio[0] = ref_ratio * IntVect::TheUnitVector();
+      fakeAmr.ref_ratio[lev] = ref_ratio[lev] * IntVect::TheUnitVector();
 
-    // Define dt_level for new levels
-    fakeAmr.dt_level[0] = fakeAmr.dt_level[1] * ref_ratio;
+      fakeAmr.dt_level[lev] = fakeAmr.dt_level[lev+1] * ref_ratio[lev];
+    }
 
     if (new_checkpoint_format) {
-      for (i = 1; i <= mx_lev; i++) is >> fakeAmr.dt_min[i];
-      fakeAmr.dt_min[0] = fakeAmr.dt_min[1] * ref_ratio;
+      for (i = n; i <= mx_lev; i++) is >> fakeAmr.dt_min[i];
+      for (int lev = n-1; lev >= 0; lev--)
+        fakeAmr.dt_min[lev] = fakeAmr.dt_min[lev+1] * ref_ratio[lev];
     } else {
       for (i = 0; i <= mx_lev; i++) fakeAmr.dt_min[i] = fakeAmr.dt_level[i];
     }
 
     // READING N_CYCLE, LEVEL_STEPS, LEVEL_COUNT
-    for (i = 1; i <= mx_lev; i++) {
+    for (i = n; i <= mx_lev; i++) {
       is >> fakeAmr.n_cycle[i];
     }
 
-    for (i = 1; i <= mx_lev; i++) {
+    for (i = n; i <= mx_lev; i++) {
       is >> fakeAmr.level_steps[i];
     }
-    for (i = 1; i <= mx_lev; i++) {
+    for (i = n; i <= mx_lev; i++) {
       is >> fakeAmr.level_count[i];
     }
 
     // ADDING LEVELS
 
-    // n_cycle is always equal to 1 at the coarsest level 
+    // n_cycle is always equal to 1 at the coarsest level
     fakeAmr.n_cycle[0] = 1;
 
-    // At the old coarsest level, which is now level 1, we set n_cycle to ref_ratio 
-    fakeAmr.n_cycle[1] = ref_ratio;
+    // At the other new levels and the old coarsest level we set n_cycle to
+    // the ratio to the next coarser level
+    for (int lev = 1; lev <= n; lev++)
+      fakeAmr.n_cycle[lev] = ref_ratio[lev-1];
 
-    fakeAmr.level_steps[0] = fakeAmr.level_steps[1] / ref_ratio;  
-    if ( (fakeAmr.level_steps[0]*ref_ratio) != fakeAmr.level_steps[1] ) 
-       amrex::Abort("Number of steps in original checkpoint must be divisible by ref_ratio");
+    for (int lev = n-1; lev >= 0; lev--) {
 
-    // level_count is how many steps we've taken at this level since the last regrid
-    if (fakeAmr.level_count[1] == fakeAmr.level_steps[1]) 
-    {
-       fakeAmr.level_count[0] = fakeAmr.level_steps[0];
+      fakeAmr.level_steps[lev] = fakeAmr.level_steps[lev+1] / ref_ratio[lev];
+      if ( (fakeAmr.level_steps[lev]*ref_ratio[lev]) != fakeAmr.level_steps[lev+1] )
+         amrex::Abort("Number of steps in original checkpoint must be divisible by the product of ref_ratio");
 
-    // this is actually wrong but should work for now
-    } else {
-       fakeAmr.level_count[0] = std::min(fakeAmr.level_count[1],fakeAmr.level_steps[0]);;
+      // level_count is how many steps we've taken at this level since the last regrid
+      if (fakeAmr.level_count[lev+1] == fakeAmr.level_steps[lev+1])
+      {
+         fakeAmr.level_count[lev] = fakeAmr.level_steps[lev];
+
+      // this is actually wrong but should work for now
+      } else {
+         fakeAmr.level_count[lev] = std::min(fakeAmr.level_count[lev+1],fakeAmr.level_steps[lev]);
+      }
     }
 
     int ndesc_save;
 
     // READ LEVEL DATA
-    for(int lev(1); lev <= fakeAmr.finest_level; ++lev) {
-      
+    for(int lev(n); lev <= fakeAmr.finest_level; ++lev) {
+
       FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
 
       is >> falRef.level;
@@ -345,6 +642,9 @@ static void ReadCheckpointFile(const std::string& fileName) {
         falRef.fine_ratio = fakeAmr.ref_ratio[falRef.level];
       }
 
+      falRef.shift = IntVect::TheZeroVector();
+      falRef.avg_ratio = 0;
+
       falRef.grids.readFrom(is);
 
       int nstate;
@@ -355,7 +655,7 @@ static void ReadCheckpointFile(const std::string& fileName) {
       ndesc_save = ndesc;
 
       // ndesc depends on which descriptor so we store a value for each
-      if (lev == 1) nsets_save.resize(ndesc_save);
+      if (lev == n) nsets_save.resize(ndesc_save);
 
       falRef.state.resize(ndesc);
       falRef.new_state.resize(ndesc);
@@ -377,43 +677,38 @@ static void ReadCheckpointFile(const std::string& fileName) {
 
         nsets_save[i] = nsets;
 
-        falRef.state[i].old_data = 0;
-        falRef.state[i].new_data = 0;
-
         std::string mf_name;
-        std::string FullPathName;
 
-        // This reads the "new" data, if it's there
+        // Note that mf_name is relative to the Header file.
+        // We need to prepend the name of the fileName directory.
+        std::string FullPathName = fileName;
+        if( ! fileName.empty() && fileName[fileName.length()-1] != '/') {
+          FullPathName += '/';
+        }
+
+        // This is the "new" data, if it's there
         if (nsets >= 1) {
-           falRef.state[i].new_data = new MultiFab;
            is >> mf_name;
-           // Note that mf_name is relative to the Header file.
-           // We need to prepend the name of the fileName directory.
-           FullPathName = fileName;
-           if( ! fileName.empty() && fileName[fileName.length()-1] != '/') {
-             FullPathName += '/';
-           }
-           FullPathName += mf_name;
-           VisMF::Read(*(falRef.state[i].new_data), FullPathName);
+           falRef.state[i].new_file = FullPathName + mf_name;
         }
 
-        // This reads the "old" data, if it's there
+        // This is the "old" data, if it's there
         if (nsets == 2) {
-          falRef.state[i].old_data = new MultiFab;
           is >> mf_name;
-          // Note that mf_name is relative to the Header file.
-          // We need to prepend the name of the fileName directory.
-          FullPathName = fileName;
-          if( ! fileName.empty() && fileName[fileName.length()-1] != '/') {
-            FullPathName += '/';
-	  }
-          FullPathName += mf_name;
-          VisMF::Read(*(falRef.state[i].old_data), FullPathName);
+          falRef.state[i].old_file = FullPathName + mf_name;
         }
 
       }
     }
 
+    // Optionally drop the finest levels. Castro averages the fine data
+    // down before writing a checkpoint, so the coarser levels already
+    // hold the coarsened data.
+    if (drop_levels > 0) {
+      fakeAmr.finest_level -= drop_levels;
+      fakeAmr.fakeAmrLevels.resize(fakeAmr.finest_level + 1);
+    }
+
     FakeAmrLevel &falRef_orig = fakeAmr.fakeAmrLevels[n];
 
     // Compute the effective max_grid_size
@@ -429,17 +724,43 @@ static void ReadCheckpointFile(const std::string& fileName) {
       FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
       falRef.level = lev;
 
-      // This version breaks up the new coarser domain based on the computed max_grid_size
-      BoxArray new_grids(domain);
-      new_grids.maxSize(max_grid_size);
+      Box domain(fakeAmr.geom[lev].Domain());
+
+      BoxArray new_grids;
+
+      if (lev == 0) {
+
+        // This version breaks up the new coarser domain based on the computed max_grid_size
+        new_grids = BoxArray(domain);
+        new_grids.maxSize(max_grid_size);
+
+        falRef.avg_ratio = 0;
+
+      } else {
+
+        // The other new levels cover the old level 0 with the coarsened old
+        // level 0 grids, so each of their boxes is the average of exactly one
+        // old box
+        int ratio = 1;
+        for (int l = lev; l < n; l++) ratio *= ref_ratio[l];
+
+        if ( ! falRef_orig.grids.coarsenable(ratio))
+          amrex::Abort("old level 0 grids must be coarsenable by the ratio to each new level");
+
+        new_grids = amrex::coarsen(falRef_orig.grids, ratio);
+
+        falRef.avg_ratio = ratio;
+
+      }
 
       falRef.grids = new_grids;
+      falRef.shift = IntVect::TheZeroVector();
 
       falRef.geom.define(domain,&prob_domain,coord);
 
-      if(falRef.level > 0) 
-        falRef.crse_ratio = ref_ratio * IntVect::TheUnitVector();
-      falRef.fine_ratio = ref_ratio * IntVect::TheUnitVector();
+      if(falRef.level > 0)
+        falRef.crse_ratio = fakeAmr.ref_ratio[lev-1];
+      falRef.fine_ratio = fakeAmr.ref_ratio[lev];
 
       falRef.state.resize(ndesc_save);
       falRef.new_state.resize(ndesc_save);
@@ -453,31 +774,127 @@ static void ReadCheckpointFile(const std::string& fileName) {
         falRef.state[i].old_time.start = falRef.state[i].new_time.start - fakeAmr.dt_level[lev];
         falRef.state[i].old_time.stop  = falRef.state[i].new_time.stop  - fakeAmr.dt_level[lev];
 
-        falRef.state[i].old_data = 0;
-        falRef.state[i].new_data = 0;
+        falRef.state[i].new_file.clear();
+        falRef.state[i].old_file.clear();
+      }
+    }
+}
 
-        if (nsets_save[i] >= 1) {
+// ---------------------------------------------------------------
 
-           int ncomp = falRef_orig.state[i].new_data->nComp();
-           int ngrow = falRef_orig.state[i].new_data->nGrow();
+// Stream the new or old data of state type i on an old level to the new
+// checkpoint. While streaming the old level 0, the new levels other than
+// level 0 are filled by averaging each box as it goes by.
 
-	   DistributionMapping dmap {falRef.grids};
-           falRef.state[i].new_data = new MultiFab(falRef.grids, dmap, ncomp, ngrow);
-           falRef.state[i].new_data->setVal(0.);
+static void StreamLevelData(const std::string& ckfile, int lev, int i, bool old_data) {
+    const int n = num_new_levels;
 
-           if (nsets_save[i] == 2) {
-             falRef.state[i].old_data = new MultiFab(falRef.grids, dmap, ncomp, ngrow);
-             falRef.state[i].old_data->setVal(0.);
-           }
+    static const std::string NewSuffix("_New_MF");
+    static const std::string OldSuffix("_Old_MF");
+    const std::string& suffix = old_data ? OldSuffix : NewSuffix;
 
-        }
+    FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
+
+    StreamedMultiFabReader reader(old_data ? falRef.state[i].old_file : falRef.state[i].new_file);
+
+    const int ncomp = reader.nComp();
+    const int ngrow = reader.nGrow();
+
+    BoxArray out_ba(reader.header().m_ba);
+    out_ba.shift(falRef.shift);
+
+    DistributionMapping dm(out_ba);
+
+    StreamedMultiFabWriter writer(ckfile + amrex::Concatenate("/Level_", lev, 1) + amrex::Concatenate("/SD_", i, 1) + suffix,
+                                  out_ba, dm, ncomp, ngrow);
+
+    // The averaged levels share the distribution of the old level 0.
+    Vector<std::unique_ptr<StreamedMultiFabWriter> > avg_writers;
+    Vector<int> avg_levels;
+
+    if (lev == n) {
+      for (int l = 1; l < n; l++) {
+        const std::string name = ckfile + amrex::Concatenate("/Level_", l, 1) + amrex::Concatenate("/SD_", i, 1) + suffix;
+        if (fakeAmr.fakeAmrLevels[l].state[i].grids.size() != out_ba.size())
+          amrex::Abort("state data grids on the old level 0 do not match the level grids");
+        avg_writers.emplace_back(new StreamedMultiFabWriter(name, fakeAmr.fakeAmrLevels[l].state[i].grids, dm, ncomp, ngrow));
+        avg_levels.push_back(l);
       }
     }
+
+    FArrayBox fab;
+    FArrayBox crse;
+
+    for (int idx = 0; idx < out_ba.size(); idx++) {
+      if (dm[idx] != ParallelDescriptor::MyProc()) continue;
+
+      reader.read(idx, fab);
+      fab.shift(falRef.shift);
+
+      writer.write(idx, fab);
+
+      for (int a = 0; a < avg_writers.size(); a++) {
+        const FakeAmrLevel &crseRef = fakeAmr.fakeAmrLevels[avg_levels[a]];
+        const Box& crse_valid = crseRef.state[i].grids[idx];
+
+        BL_ASSERT(amrex::refine(crse_valid, crseRef.avg_ratio) == out_ba[idx]);
+
+        crse.resize(amrex::grow(crse_valid, ngrow), ncomp);
+        crse.setVal(0.);
+        AverageDown(fab, crse, crse_valid, crseRef.avg_ratio);
+
+        avg_writers[a]->write(idx, crse);
+      }
+    }
+
+    writer.finish();
+
+    for (auto& w : avg_writers) {
+      w->finish();
+    }
+}
+
+// ---------------------------------------------------------------
+
+// Write zeros for the new or old data of state type i on the new level 0;
+// Castro fills it in when it restarts with grown_factor > 1.
+
+static void WriteZeroLevelData(const std::string& ckfile, int i, bool old_data) {
+    static const std::string NewSuffix("_New_MF");
+    static const std::string OldSuffix("_Old_MF");
+    const std::string& suffix = old_data ? OldSuffix : NewSuffix;
+
+    // Take the number of components and ghost cells from the old level 0.
+    const FakeStateData &orig = fakeAmr.fakeAmrLevels[num_new_levels].state[i];
+
+    VisMF::Header hdr;
+    ReadMultiFabHeader(old_data ? orig.old_file : orig.new_file, hdr);
+
+    const int ncomp = hdr.m_ncomp;
+    const int ngrow = hdr.m_ngrow[0];
+
+    const BoxArray& ba = fakeAmr.fakeAmrLevels[0].state[i].grids;
+    DistributionMapping dm(ba);
+
+    StreamedMultiFabWriter writer(ckfile + "/Level_0" + amrex::Concatenate("/SD_", i, 1) + suffix,
+                                  ba, dm, ncomp, ngrow);
+
+    FArrayBox fab;
+
+    for (int idx = 0; idx < ba.size(); idx++) {
+      if (dm[idx] != ParallelDescriptor::MyProc()) continue;
+
+      fab.resize(amrex::grow(ba[idx], ngrow), ncomp);
+      fab.setVal(0.);
+
+      writer.write(idx, fab);
+    }
+
+    writer.finish();
 }
 
 // ---------------------------------------------------------------
 static void WriteCheckpointFile(const std::string& inFileName, const std::string &outFileName) {
-    VisMF::SetNOutFiles(nFiles);
     // In checkpoint files always write out FABs in NATIVE format.
     FABio::Format thePrevFormat = FArrayBox::getFormat();
     FArrayBox::setFormat(FABio::FAB_NATIVE);
@@ -592,8 +1009,6 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
           amrex::CreateDirectoryFailed(FullPath);
         }
       }
-      // Force other processors to wait till directory is built.
-      ParallelDescriptor::Barrier();
 
       if(ParallelDescriptor::IOProcessor()) {
         os << lev << '\n' << falRef.geom  << '\n';
@@ -601,7 +1016,8 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
         os << ndesc << '\n';
       }
       //
-      // Output state data.
+      // Output the state data descriptions; the data themselves are
+      // streamed below.
       //
       for(int i(0); i < ndesc; ++i) {
         //
@@ -609,23 +1025,15 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
         // The name is relative to the Header file containing this name.
         // It's the name that gets written into the Header.
         //
-        // There is only one MultiFab written out at each level in HyperCLaw.
-        //
         std::string PathNameInHeader = Level;
         sprintf(buf, "/SD_%d", i);
         PathNameInHeader += buf;
-        std::string FullPathName = FullPath;
-        FullPathName += buf;
         // ++++++++++++ state[i].checkPoint(PathNameInHeader, FullPathName, os, how);
           static const std::string NewSuffix("_New_MF");
           static const std::string OldSuffix("_Old_MF");
           const std::string name(PathNameInHeader);
-          const std::string fullpathname(FullPathName);
 
-          bool dump_old(true);
-          if(dump_old == true && falRef.state[i].old_data == 0) {
-            dump_old = false;
-          }
+          bool dump_old(nsets_save[i] == 2);
 
           if(ParallelDescriptor::IOProcessor()) {
             // The relative name gets written to the Header file.
@@ -654,21 +1062,6 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
             }
 
           }
-
-          if (nsets_save[i] > 0) {
-             BL_ASSERT(falRef.state[i].new_data);
-             std::string mf_fullpath_new = fullpathname;
-             mf_fullpath_new += NewSuffix;
-             VisMF::Write(*(falRef.state[i].new_data),mf_fullpath_new,how);
-          }
-
-          if (nsets_save[i] > 1) {
-            BL_ASSERT(dump_old);
-            BL_ASSERT(falRef.state[i].old_data);
-            std::string mf_fullpath_old = fullpathname;
-	    mf_fullpath_old += OldSuffix;
-            VisMF::Write(*(falRef.state[i].old_data),mf_fullpath_old,how);
-          }
           // ++++++++++++
       }
       // ========================
@@ -695,6 +1088,27 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
 	}
     }
 
+    // Force other processors to wait till the level directories are built.
+    ParallelDescriptor::Barrier();
+
+    //
+    // Now stream the data: the old levels (which also fills the new
+    // levels between level 0 and the old level 0), then the new level 0.
+    //
+    int ndesc = nsets_save.size();
+
+    for(int lev(num_new_levels); lev <= fakeAmr.finest_level; ++lev) {
+      for(int i(0); i < ndesc; ++i) {
+        if (nsets_save[i] > 0) StreamLevelData(ckfile, lev, i, false);
+        if (nsets_save[i] > 1) StreamLevelData(ckfile, lev, i, true);
+      }
+    }
+
+    for(int i(0); i < ndesc; ++i) {
+      if (nsets_save[i] > 0) WriteZeroLevelData(ckfile, i, false);
+      if (nsets_save[i] > 1) WriteZeroLevelData(ckfile, i, true);
+    }
+
     FArrayBox::setFormat(thePrevFormat);
 }
 
@@ -879,7 +1293,7 @@ static void ConvertData() {
    //    but isn't automatically set.
    fakeAmr.geom[0].SetOffset(xlo);
 
-   IntVect shift_iv[max_level+1];
+   Vector<IntVect> shift_iv(max_level+1, IntVect::TheZeroVector());
 
    // Define the shift IntVect for later
    if (star_at_center == 1)
@@ -925,42 +1339,8 @@ static void ConvertData() {
          falRef.state[n].domain.refine(grown_factor);
    }
 
-   DistributionMapping newdm {newgrids};
-
-   // We need to allocate a MultiFab for new data but don't need to fill it
-   for (int n = 0; n < nstatetypes; n++) 
-   {
-      if (falRef0.state[n].new_data != 0) {
-         int ncomps = (falRef0.state[n].new_data)->nComp();
-         MultiFab * newNewData = new MultiFab(newgrids,newdm,ncomps,1);
-
-         newNewData->setVal(0.); 
-
-         if (star_at_center == 1)  
-            (falRef0.state[n].new_data)->shift(shift_iv[0]);
-
-         falRef0.state[n].new_data = newNewData;
-   
-//       newNewData->copy(*(falRef0.state[n].new_data),0,0,ncomps);
-      }
-   } 
-
-   // If we have old_data as well as new_data
-   for (int n = 0; n < nstatetypes; n++) 
-   {
-      if (falRef0.state[n].old_data != 0) {
-         int ncomps = (falRef0.state[n].old_data)->nComp();
-         MultiFab * newOldData = new MultiFab(newgrids,newdm,ncomps,1);
-         newOldData->setVal(0.);
-
-         if (star_at_center == 1)  
-            (falRef0.state[n].old_data)->shift(shift_iv[0]);
-
-         falRef0.state[n].old_data = newOldData;
-
-//       newOldData->copy(*(falRef0.state[n].old_data),0,0,ncomps);
-      }
-   }
+   // The new level 0 data are written as zeros, so there is nothing
+   // to allocate here.
 
    // Now shift the data at the higher levels
    if (star_at_center == 1) {
@@ -975,13 +1355,10 @@ static void ConvertData() {
          {
             // Shift the grids associated with each StateData
             falRef.state[n].grids.shift(shift_iv[i]);
-
-            // Shift the grids associated with the MultiFab in each StateData
-            if (falRef0.state[n].new_data != 0) 
-               (falRef.state[n].new_data)->shift(shift_iv[i]);
-            if (falRef0.state[n].old_data != 0) 
-               (falRef.state[n].old_data)->shift(shift_iv[i]);
          }
+
+         // The boxes of the data are shifted as they are streamed
+         falRef.shift = shift_iv[i];
       }
    }
 }
@@ -1009,18 +1386,25 @@ int main(int argc, char *argv[]) {
       cout << " " << std::endl;
     }
 
-    // Read in the original checkpoint directory and add a coarser level covering the same domain 
+    // Read in the original checkpoint header and add the coarser levels covering the same domain
     ReadCheckpointFile(CheckFileIn);
 
     // Enlarge the new level 0
     ConvertData();
 
     // Write out the new checkpoint directory
+    Real write_start = ParallelDescriptor::second();
+
     WriteCheckpointFile(CheckFileIn, CheckFileOut);
 
+    Real write_time = ParallelDescriptor::second() - write_start;
+    ParallelDescriptor::ReduceRealMax(write_time, ParallelDescriptor::IOProcessorNumber());
+    ParallelDescriptor::ReduceLongSum(bytes_written, ParallelDescriptor::IOProcessorNumber());
+
     if(verbose && ParallelDescriptor::IOProcessor()) {
       cout << " " << std::endl;
       cout << "Finished writing to new checkpoint file: " <<  CheckFileOut << endl;
+      cout << "Wrote " << bytes_written / (1024.0 * 1024.0) << " MB in " << write_time << " s" << endl;
       cout << " " << std::endl;
     }
 
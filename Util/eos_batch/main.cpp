@@ -0,0 +1,224 @@
+// Compare the batched EOS path in Castro_eos_batch.H with the zone by
+// zone path, for the (rho, e) call that ctoprim makes.
+//
+// The test box is filled with a smooth but nonuniform thermodynamic state,
+// so that neighboring zones are not identical. The composition either
+// varies from zone to zone too or is the same everywhere; the batched path
+// shares the composition setup between neighboring zones in the latter
+// case. Each path is timed over the tiles of the box, and the two results
+// are compared.
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_FArrayBox.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <extern_parameters.H>
+#include <eos.H>
+#include <network.H>
+
+#include <Castro_eos_batch.H>
+#include <eos_batch_F.H>
+
+using namespace amrex;
+
+namespace
+{
+    // component layout of the test data
+    constexpr int IRHO = 0;
+    constexpr int IEINT = 1;
+    constexpr int ITEMP = 2;
+    constexpr int IPRES = 3;
+    constexpr int ICS = 4;
+    constexpr int ISPEC = 5;
+    constexpr int NCOMP = ISPEC + NumSpec;
+
+    Real run (const BoxArray& tiles, FArrayBox& fab, const FArrayBox& temp_guess,
+              const bool batched, const int n_iter)
+    {
+        Array4<Real> const a = fab.array();
+        Array4<Real const> const T0 = temp_guess.const_array();
+
+        auto eos_gather = [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k, eos_t& eos_state)
+        {
+            eos_state.rho = a(i,j,k,IRHO);
+            eos_state.e = a(i,j,k,IEINT);
+            eos_state.T = T0(i,j,k);
+            for (int n = 0; n < NumSpec; ++n) {
+                eos_state.xn[n] = a(i,j,k,ISPEC+n);
+            }
+        };
+
+        auto eos_scatter = [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k, eos_t const& eos_state)
+        {
+            a(i,j,k,ITEMP) = eos_state.T;
+            a(i,j,k,IPRES) = eos_state.p;
+            a(i,j,k,ICS) = eos_state.cs;
+        };
+
+        // one untimed pass to warm up the caches and any tables
+
+        for (int t = 0; t < tiles.size(); ++t) {
+            eos_apply(tiles[t], eos_input_re, batched, eos_gather, eos_scatter);
+        }
+
+        Real start = ParallelDescriptor::second();
+
+        for (int iter = 0; iter < n_iter; ++iter) {
+            for (int t = 0; t < tiles.size(); ++t) {
+                eos_apply(tiles[t], eos_input_re, batched, eos_gather, eos_scatter);
+            }
+        }
+
+        Gpu::synchronize();
+
+        return ParallelDescriptor::second() - start;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+
+    {
+        ParmParse pp("eos_batch");
+
+        int n_cell = 64;
+        pp.query("n_cell", n_cell);
+
+        int n_iter = 10;
+        pp.query("n_iter", n_iter);
+
+        Vector<int> tile_size(AMREX_SPACEDIM, 16);
+        tile_size[0] = 1024;
+        pp.queryarr("tile_size", tile_size, 0, AMREX_SPACEDIM);
+
+        Real dens_min = 1.e4, dens_max = 1.e9;
+        Real temp_min = 1.e7, temp_max = 5.e9;
+        pp.query("dens_min", dens_min);
+        pp.query("dens_max", dens_max);
+        pp.query("temp_min", temp_min);
+        pp.query("temp_max", temp_max);
+
+        int uniform_composition = 0;
+        pp.query("uniform_composition", uniform_composition);
+
+        std::string probin_file = "probin";
+        pp.query("probin_file", probin_file);
+
+        // Initialize the microphysics the same way Castro does.
+
+        const int probin_file_length = probin_file.length();
+        Vector<int> probin_file_name(probin_file_length);
+
+        for (int i = 0; i < probin_file_length; i++) {
+            probin_file_name[i] = probin_file[i];
+        }
+
+        ca_extern_init(probin_file_name.dataPtr(), &probin_file_length);
+        init_extern_parameters();
+
+        microphysics_init();
+        eos_init();
+
+        const Box domain(IntVect(AMREX_D_DECL(0, 0, 0)),
+                         IntVect(AMREX_D_DECL(n_cell-1, n_cell-1, n_cell-1)));
+
+        BoxArray tiles(domain);
+        tiles.maxSize(IntVect(AMREX_D_DECL(tile_size[0], tile_size[1], tile_size[2])));
+
+        FArrayBox fab(domain, NCOMP);
+        FArrayBox temp_guess(domain, 1);
+
+        // Fill the box with (rho, T, X) spread logarithmically in rho and T
+        // and a composition that varies from zone to zone (unless it is
+        // uniform), then get e from
+        // the EOS. The initial guess for T is perturbed so that the (rho, e)
+        // inversion has work to do.
+
+        Array4<Real> const a = fab.array();
+        Array4<Real> const T0 = temp_guess.array();
+
+        const Real ldens = std::log(dens_max / dens_min);
+        const Real ltemp = std::log(temp_max / temp_min);
+
+        AMREX_PARALLEL_FOR_3D(domain, i, j, k,
+        {
+            const Real fi = (i + 0.5_rt) / n_cell;
+            const Real fj = (j + 0.5_rt) / n_cell;
+            const Real fk = (k + 0.5_rt) / n_cell;
+
+            eos_t eos_state;
+
+            eos_state.rho = dens_min * std::exp(ldens * fi);
+            eos_state.T = temp_min * std::exp(ltemp * 0.5_rt * (fj + fk));
+
+            Real sum = 0.0_rt;
+            for (int n = 0; n < NumSpec; ++n) {
+                if (uniform_composition == 1) {
+                    eos_state.xn[n] = 1.0_rt + 0.5_rt * std::sin(1.0_rt + n);
+                } else {
+                    eos_state.xn[n] = 1.0_rt + 0.5_rt * std::sin(1.0_rt + n + 7.0_rt * fi + 3.0_rt * fj + 5.0_rt * fk);
+                }
+                sum += eos_state.xn[n];
+            }
+            for (int n = 0; n < NumSpec; ++n) {
+                eos_state.xn[n] /= sum;
+                a(i,j,k,ISPEC+n) = eos_state.xn[n];
+            }
+
+            eos(eos_input_rt, eos_state);
+
+            a(i,j,k,IRHO) = eos_state.rho;
+            a(i,j,k,IEINT) = eos_state.e;
+            T0(i,j,k) = 1.1_rt * eos_state.T;
+        });
+
+        FArrayBox fab_batch(domain, NCOMP);
+        fab_batch.copy(fab);
+
+        const Real t_zone = run(tiles, fab, temp_guess, false, n_iter);
+        const Real t_batch = run(tiles, fab_batch, temp_guess, true, n_iter);
+
+        // The two paths evaluate the same EOS on the same inputs, so they
+        // should agree to roundoff.
+
+        Real max_diff = 0.0_rt;
+        for (int n : {ITEMP, IPRES, ICS}) {
+            Array4<Real const> const z = fab.const_array();
+            Array4<Real const> const b = fab_batch.const_array();
+            const auto lo = lbound(domain);
+            const auto hi = ubound(domain);
+            for (int k = lo.z; k <= hi.z; ++k) {
+                for (int j = lo.y; j <= hi.y; ++j) {
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        max_diff = amrex::max(max_diff, std::abs(b(i,j,k,n) - z(i,j,k,n)) / std::abs(z(i,j,k,n)));
+                    }
+                }
+            }
+        }
+
+        const Real nzones = static_cast<Real>(domain.numPts()) * n_iter;
+
+        amrex::Print() << std::endl;
+        amrex::Print() << "EOS batch benchmark: " << domain.numPts() << " zones in "
+                       << tiles.size() << " tiles, " << NumSpec << " species, "
+                       << (uniform_composition == 1 ? "uniform" : "nonuniform") << " composition, "
+                       << n_iter << " iterations, batch size " << eos_batch_size << std::endl;
+        amrex::Print() << std::setprecision(4);
+        amrex::Print() << "  zone by zone: " << 1.e9 * t_zone / nzones << " ns / zone" << std::endl;
+        amrex::Print() << "  batched:      " << 1.e9 * t_batch / nzones << " ns / zone" << std::endl;
+        amrex::Print() << "  speedup:      " << t_zone / t_batch << std::endl;
+        amrex::Print() << "  max relative difference in T, p, cs: " << max_diff << std::endl;
+        amrex::Print() << std::endl;
+
+        eos_finalize();
+    }
+
+    amrex::Finalize();
+}
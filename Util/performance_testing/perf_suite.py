@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+
+"""
+Performance regression suite.
+
+Builds and runs short, fixed-step versions of the problems listed in
+benchmarks.ini with castro.perf_log_file set, and compares the time per
+step spent in each subsystem (hydro, sources, gravity, burn, radiation,
+regrid, io, the rest and the total) against a stored baseline.
+
+    perf_suite.py                       build, run and compare everything
+    perf_suite.py Sedov-2d wdmerger     only these benchmarks
+    perf_suite.py --update              (re)write the baselines instead
+
+The time per step of a subsystem is the median over the steps of the
+run, leaving out the first step(s), which include setup costs. With
+--repeat N each benchmark is run N times and the fastest run of each
+subsystem is kept. A subsystem is reported as slower if it takes more
+than (1 + tolerance) times its baseline; subsystems that are cheaper
+than min_time in the baseline are not checked. The zones advanced, MLMG
+iterations and burner RHS evaluations are reported next to the timings,
+so that a slowdown caused by more work (e.g., more solver iterations)
+can be told apart from slower code. The exit status is 1 if anything
+got slower.
+
+Baselines are specific to a machine and build, and are kept in
+baselines/<machine>/<benchmark>.json, where <machine> defaults to the
+host name.
+"""
+
+import argparse
+import configparser
+import glob
+import json
+import os
+import platform
+import shlex
+import shutil
+import statistics
+import subprocess
+import sys
+
+REGIONS = ["hydro", "sources", "gravity", "burn", "radiation", "regrid", "io", "other", "total"]
+
+SUITE_DIR = os.path.dirname(os.path.abspath(__file__))
+
+
+def read_perf_log(filename):
+    """return the list of records in a Castro performance log"""
+
+    records = []
+    with open(filename) as f:
+        for line in f:
+            line = line.strip()
+            if line:
+                records.append(json.loads(line))
+    return records
+
+
+def summarize(records, skip):
+    """reduce the records of one run to the median time per step of each
+    subsystem and the work done per step"""
+
+    if len(records) <= skip:
+        raise ValueError(f"only {len(records)} steps were logged; need more than {skip}")
+
+    records = records[skip:]
+
+    times = {r: statistics.median(rec["wall_time"][r] for rec in records) for r in REGIONS}
+
+    nsteps = len(records)
+    work = {"zones_advanced": sum(sum(rec["zones_advanced"]) for rec in records) / nsteps,
+            "mlmg_iters": sum(sum(rec["mlmg_iters"]) for rec in records) / nsteps,
+            "burn_rhs": sum(rec["burn_rhs"] for rec in records) / nsteps,
+            "retries": sum(rec["retries"] for rec in records)}
+
+    memory = max(rec["memory"]["fab_bytes_hwm"] for rec in records)
+
+    return {"time_per_step": times, "work_per_step": work, "fab_bytes_hwm": memory}
+
+
+def build(castro_home, bench, jobs):
+    """build the benchmark's executable and return its path"""
+
+    problem_dir = os.path.join(castro_home, bench["dir"])
+
+    cmd = ["make", f"-j{jobs}", f"DIM={bench['dim']}"] + shlex.split(bench["make_options"])
+    print(f"  building: {' '.join(cmd)}")
+    subprocess.run(cmd, cwd=problem_dir, check=True, stdout=subprocess.DEVNULL)
+
+    exes = glob.glob(os.path.join(problem_dir, f"Castro{bench['dim']}d*.ex"))
+    if not exes:
+        raise RuntimeError(f"no Castro{bench['dim']}d executable found in {problem_dir}")
+
+    return max(exes, key=os.path.getmtime)
+
+
+def run(castro_home, name, bench, exe, mpirun, work_dir):
+    """run the benchmark once and return the records of its performance log"""
+
+    problem_dir = os.path.join(castro_home, bench["dir"])
+    run_dir = os.path.join(work_dir, name)
+
+    if os.path.isdir(run_dir):
+        shutil.rmtree(run_dir)
+    os.makedirs(run_dir)
+
+    # The run needs the probin, initial models, EOS tables, etc. from
+    # the problem directory; link them all so the output stays out of it.
+
+    for f in os.listdir(problem_dir):
+        src = os.path.join(problem_dir, f)
+        if os.path.isfile(src):
+            os.symlink(src, os.path.join(run_dir, f))
+
+    cmd = [exe, bench["inputs"]]
+    cmd += shlex.split(bench["common_params"])
+    cmd += shlex.split(bench["runtime_params"])
+    cmd += ["castro.perf_log_file=perf_log.jsonl"]
+
+    nprocs = int(bench["nprocs"])
+    if nprocs > 0:
+        cmd = shlex.split(mpirun) + [str(nprocs)] + cmd
+
+    with open(os.path.join(run_dir, "run.out"), "w") as out:
+        subprocess.run(cmd, cwd=run_dir, check=True, stdout=out, stderr=subprocess.STDOUT)
+
+    return read_perf_log(os.path.join(run_dir, "perf_log.jsonl"))
+
+
+def best_of(summaries):
+    """combine repeated runs, keeping the fastest time of each subsystem"""
+
+    best = summaries[0]
+    for s in summaries[1:]:
+        for r in REGIONS:
+            best["time_per_step"][r] = min(best["time_per_step"][r], s["time_per_step"][r])
+    return best
+
+
+def compare(name, summary, baseline, tolerance, min_time):
+    """print the comparison with the baseline and return the subsystems that got slower"""
+
+    slower = []
+
+    print(f"  {'subsystem':>10s} {'baseline (s)':>13s} {'now (s)':>13s} {'ratio':>7s}")
+
+    for r in REGIONS:
+        old = baseline["time_per_step"][r]
+        new = summary["time_per_step"][r]
+
+        if old < min_time:
+            print(f"  {r:>10s} {old:13.5g} {new:13.5g} {'':>7s}  (not checked)")
+            continue
+
+        ratio = new / old
+        status = ""
+        if ratio > 1.0 + tolerance:
+            status = "SLOWER"
+            slower.append(r)
+        elif ratio < 1.0 - tolerance:
+            status = "faster"
+
+        print(f"  {r:>10s} {old:13.5g} {new:13.5g} {ratio:7.3f}  {status}")
+
+    for w in summary["work_per_step"]:
+        old = baseline["work_per_step"].get(w, 0)
+        new = summary["work_per_step"][w]
+        if old != new:
+            print(f"  {w} per step changed: {old:.6g} -> {new:.6g}")
+
+    if slower:
+        print(f"  {name}: slower in {', '.join(slower)}")
+
+    return slower
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("benchmarks", nargs="*",
+                        help="benchmarks to run (default: all in the config file)")
+    parser.add_argument("--config", default=os.path.join(SUITE_DIR, "benchmarks.ini"),
+                        help="benchmark definitions")
+    parser.add_argument("--castro-home", default=os.environ.get("CASTRO_HOME",
+                                                                os.path.join(SUITE_DIR, "..", "..")),
+                        help="Castro source directory (default: $CASTRO_HOME or this checkout)")
+    parser.add_argument("--machine", default=platform.node().split(".")[0],
+                        help="name of the baseline set to use (default: the host name)")
+    parser.add_argument("--work-dir", default="perf_runs",
+                        help="directory in which to run the benchmarks")
+    parser.add_argument("--mpirun", default=os.environ.get("MPIRUN", "mpiexec -n"),
+                        help="MPI launcher, followed by the number of ranks (default: $MPIRUN or 'mpiexec -n')")
+    parser.add_argument("--make-jobs", type=int, default=8,
+                        help="number of parallel make jobs")
+    parser.add_argument("--no-build", action="store_true",
+                        help="use the existing executables")
+    parser.add_argument("--repeat", type=int, default=1,
+                        help="number of runs of each benchmark")
+    parser.add_argument("--skip-steps", type=int, default=1,
+                        help="number of initial steps to leave out")
+    parser.add_argument("--update", action="store_true",
+                        help="write the results as the new baselines")
+    args = parser.parse_args()
+
+    config = configparser.ConfigParser()
+    config.optionxform = str
+    if not config.read(args.config):
+        sys.exit(f"could not read {args.config}")
+
+    names = args.benchmarks if args.benchmarks else config.sections()
+    for name in names:
+        if not config.has_section(name):
+            sys.exit(f"unknown benchmark {name}")
+
+    castro_home = os.path.abspath(args.castro_home)
+    work_dir = os.path.abspath(args.work_dir)
+    baseline_dir = os.path.join(SUITE_DIR, "baselines", args.machine)
+
+    regressions = {}
+
+    for name in names:
+        bench = config[name]
+        print(f"{name}:")
+
+        if args.no_build:
+            problem_dir = os.path.join(castro_home, bench["dir"])
+            exes = glob.glob(os.path.join(problem_dir, f"Castro{bench['dim']}d*.ex"))
+            if not exes:
+                sys.exit(f"no executable for {name}; build it or drop --no-build")
+            exe = max(exes, key=os.path.getmtime)
+        else:
+            exe = build(castro_home, bench, args.make_jobs)
+
+        summaries = []
+        for _ in range(args.repeat):
+            records = run(castro_home, name, bench, exe, args.mpirun, work_dir)
+            summaries.append(summarize(records, args.skip_steps))
+
+        summary = best_of(summaries)
+        summary["executable"] = os.path.basename(exe)
+        summary["nprocs"] = int(bench["nprocs"])
+
+        baseline_file = os.path.join(baseline_dir, f"{name}.json")
+
+        if args.update:
+            os.makedirs(baseline_dir, exist_ok=True)
+            with open(baseline_file, "w") as f:
+                json.dump(summary, f, indent=2)
+            print(f"  wrote {baseline_file}")
+            continue
+
+        if not os.path.isfile(baseline_file):
+            print(f"  no baseline for machine {args.machine}; run with --update to create one")
+            continue
+
+        with open(baseline_file) as f:
+            baseline = json.load(f)
+
+        slower = compare(name, summary, baseline,
+                         float(bench["tolerance"]), float(bench["min_time"]))
+        if slower:
+            regressions[name] = slower
+
+    if regressions:
+        print("")
+        print("performance regressions:")
+        for name, slower in regressions.items():
+            print(f"  {name}: {', '.join(slower)}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,46 @@
+#!/bin/bash
+
+# Compare the FFT and MLMG Poisson solvers on the uniform_cube_sphere
+# (isolated and periodic) and evrard_collapse problems at several
+# resolutions. Each run writes its output to <problem>_<bc>_<n>.out.
+#
+# The launcher, rank count and executables can be set through the
+# environment, e.g.
+#
+#   MPIRUN="srun -n" NRANKS=64 UCS_EX=... EVRARD_EX=... ./run_fft_compare.sh
+
+MPIRUN=${MPIRUN:-"mpiexec -n"}
+NRANKS=${NRANKS:-8}
+UCS_EX=${UCS_EX:-./Castro3d.gnu.MPI.uniform_cube_sphere.ex}
+EVRARD_EX=${EVRARD_EX:-./Castro3d.gnu.MPI.evrard_collapse.ex}
+SIZES=${SIZES:-"64 128 256"}
+
+CASTRO_HOME=${CASTRO_HOME:-../../..}
+UCS_DIR=${CASTRO_HOME}/Exec/gravity_tests/uniform_cube_sphere
+EVRARD_DIR=${CASTRO_HOME}/Exec/gravity_tests/evrard_collapse
+
+export OMP_NUM_THREADS=${OMP_NUM_THREADS:-1}
+
+common="amr.max_level=0 amr.plot_files_output=0 amr.checkpoint_files_output=0 gravity.fft_solver=1 gravity.fft_compare=1"
+
+for n in ${SIZES}
+do
+    ${MPIRUN} ${NRANKS} ${UCS_EX} ${UCS_DIR}/inputs amr.probin_file=${UCS_DIR}/probin \
+        ${common} amr.n_cell="${n} ${n} ${n}" amr.max_grid_size=32 \
+        > uniform_cube_sphere_isolated_${n}.out 2>&1
+
+    ${MPIRUN} ${NRANKS} ${UCS_EX} ${UCS_DIR}/inputs amr.probin_file=${UCS_DIR}/probin \
+        ${common} amr.n_cell="${n} ${n} ${n}" amr.max_grid_size=32 \
+        geometry.is_periodic="1 1 1" castro.lo_bc="0 0 0" castro.hi_bc="0 0 0" \
+        > uniform_cube_sphere_periodic_${n}.out 2>&1
+
+    ${MPIRUN} ${NRANKS} ${EVRARD_EX} ${EVRARD_DIR}/inputs amr.probin_file=${EVRARD_DIR}/probin \
+        ${common} amr.n_cell="${n} ${n} ${n}" amr.max_grid_size=32 max_step=10 \
+        > evrard_collapse_isolated_${n}.out 2>&1
+done
+
+for f in uniform_cube_sphere_*.out evrard_collapse_*.out
+do
+    echo "${f}:"
+    grep "Gravity FFT / MLMG comparison" ${f}
+done
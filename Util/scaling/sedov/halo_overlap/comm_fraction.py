@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+
+"""Summarize the ghost zone exchange for the hydro from the output of
+the runs made by run_overlap.sh.
+
+With castro.v >= 1 and castro.hydro_overlap_comm = 1, every hydro
+update on a level prints a line like
+
+  ... level 0 ghost exchange: wait = 0.0123 s, hydro = 0.456 s, communication fraction = 0.0263 (overlapped, 89915392 of 134217728 zones updated during the exchange)
+
+This prints the communication fraction for each step of each run, and
+then a table of the mean wait, hydro time and communication fraction
+for the blocking and overlapped runs at each rank count. For the
+overlapped runs it also prints the fraction of the zones that were
+updated while the exchange was in progress, and warns if there were
+none, since then nothing was overlapped.
+"""
+
+import re
+import sys
+
+LINE = re.compile(r"level\s+(\d+) ghost exchange: wait = (\S+) s, hydro = (\S+) s, "
+                  r"communication fraction = (\S+) \((\w+)(?:, (\d+) of (\d+) zones[^)]*)?\)")
+
+NAME = re.compile(r"sedov_(\d+)_overlap(\d)\.out")
+
+
+def read_run(filename):
+    """Return a list of (wait, hydro, fraction, overlapped zone fraction)
+    for the level 0 updates."""
+
+    steps = []
+    with open(filename) as f:
+        for line in f:
+            m = LINE.search(line)
+            if m is None or int(m.group(1)) != 0:
+                continue
+            zone_frac = 0.0
+            if m.group(6) is not None and int(m.group(7)) > 0:
+                zone_frac = float(m.group(6)) / float(m.group(7))
+            steps.append((float(m.group(2)), float(m.group(3)), float(m.group(4)), zone_frac))
+    return steps
+
+
+def main(files):
+
+    runs = {}
+
+    for filename in files:
+        m = NAME.search(filename)
+        if m is None:
+            continue
+        steps = read_run(filename)
+        if not steps:
+            print("no ghost exchange timings in {}; was castro.v = 1?".format(filename))
+            continue
+        runs[(int(m.group(1)), int(m.group(2)))] = steps
+
+    for (ranks, overlap), steps in sorted(runs.items()):
+        print("{} ranks, {}:".format(ranks, "overlapped" if overlap else "blocking"))
+        print("  {:>5s} {:>12s} {:>12s} {:>10s} {:>10s}".format("step", "wait (s)", "hydro (s)", "fraction",
+                                                               "overlapped"))
+        for n, (wait, hydro, frac, zone_frac) in enumerate(steps):
+            print("  {:5d} {:12.5g} {:12.5g} {:10.4f} {:10.4f}".format(n+1, wait, hydro, frac, zone_frac))
+        if overlap and all(s[3] == 0.0 for s in steps):
+            print("  warning: no zones were updated during the exchange")
+        print("")
+
+    print("{:>6s} {:>11s} {:>12s} {:>12s} {:>10s}".format("ranks", "mode", "wait (s)", "hydro (s)", "fraction"))
+
+    for (ranks, overlap), steps in sorted(runs.items()):
+        # skip the first step, which includes setting up the communication metadata
+        if len(steps) > 1:
+            steps = steps[1:]
+        wait = sum(s[0] for s in steps) / len(steps)
+        hydro = sum(s[1] for s in steps) / len(steps)
+        print("{:6d} {:>11s} {:12.5g} {:12.5g} {:10.4f}".format(ranks, "overlapped" if overlap else "blocking",
+                                                               wait, hydro, wait / (wait + hydro)))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# Run the 3-d Sedov problem on a single level with the blocking and
+# the overlapped ghost zone exchange for the hydro, at several MPI
+# rank counts. Each run writes its output to sedov_<ranks>_overlap<0|1>.out.
+#
+# The launcher and executable can be set through the environment, e.g.
+#
+#   MPIRUN="srun -n" CASTRO_EX=./Castro3d.gnu.MPI.ex ./run_overlap.sh
+
+MPIRUN=${MPIRUN:-"mpiexec -n"}
+CASTRO_EX=${CASTRO_EX:-./Castro3d.gnu.MPI.ex}
+RANKS=${RANKS:-"64 128 256 512"}
+
+inputs_file=inputs.3d.sph_1level
+
+export OMP_NUM_THREADS=${OMP_NUM_THREADS:-1}
+
+for n_mpi in ${RANKS}
+do
+    for overlap in 0 1
+    do
+        outfile=sedov_${n_mpi}_overlap${overlap}.out
+
+        ${MPIRUN} ${n_mpi} ${CASTRO_EX} ${inputs_file} castro.hydro_overlap_comm=${overlap} > ${outfile} 2>&1
+    done
+done
+
+python3 comm_fraction.py sedov_*_overlap*.out
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+
+"""
+Read the binary streaming files written by Castro's in-situ analysis
+output (castro.insitu_interval / castro.insitu_per).  See
+Source/driver/Castro_insitu.cpp for a description of the format.
+
+Usage as a script prints a summary of each record:
+
+    read_insitu.py insitu_reductions.bin
+
+As a module, read_insitu(filename) returns the list of variable names
+and a list of records.  Each record is a dictionary with the keys
+"step" and "time", and
+
+  slices:      "normal", "position", "lo", "dx" and "data", a numpy
+               array indexed as [var, i2, i1]
+
+  profiles:    "r" (the bin centers) and "data", a numpy array indexed
+               as [var, bin]
+
+  reductions:  "min", "max" and "integral", numpy arrays indexed by var
+"""
+
+import struct
+import sys
+
+import numpy as np
+
+KINDS = ["slice", "profile", "reductions"]
+
+
+def read_insitu(filename):
+    """read an in-situ output file, returning (kind, names, records)"""
+
+    with open(filename, "rb") as f:
+        buf = f.read()
+
+    if buf[0:8] != b"CAINSITU":
+        raise ValueError(f"{filename} is not a Castro in-situ output file")
+
+    pos = 8
+    version, kind, nvars = struct.unpack_from("=iii", buf, pos)
+    pos += 12
+
+    if version != 1:
+        raise ValueError(f"unknown in-situ format version {version}")
+
+    names = []
+    for _ in range(nvars):
+        (n,) = struct.unpack_from("=i", buf, pos)
+        pos += 4
+        names.append(buf[pos:pos+n].decode())
+        pos += n
+
+    records = []
+
+    while pos < len(buf):
+        (nbytes,) = struct.unpack_from("=q", buf, pos)
+        pos += 8
+        end = pos + nbytes
+
+        step, time = struct.unpack_from("=qd", buf, pos)
+        pos += 16
+        rec = {"step": step, "time": time}
+
+        if KINDS[kind] == "slice":
+            normal, position, n1, n2 = struct.unpack_from("=idii", buf, pos)
+            pos += 20
+            lo1, lo2, d1, d2 = struct.unpack_from("=dddd", buf, pos)
+            pos += 32
+            rec["normal"] = normal
+            rec["position"] = position
+            rec["lo"] = (lo1, lo2)
+            rec["dx"] = (d1, d2)
+            rec["data"] = np.frombuffer(buf, dtype=np.float32, count=nvars*n1*n2,
+                                        offset=pos).reshape(nvars, n2, n1)
+
+        elif KINDS[kind] == "profile":
+            nbins, dr = struct.unpack_from("=id", buf, pos)
+            pos += 12
+            rec["r"] = (np.arange(nbins) + 0.5) * dr
+            rec["data"] = np.frombuffer(buf, dtype=np.float32, count=nvars*nbins,
+                                        offset=pos).reshape(nvars, nbins)
+
+        else:
+            vals = np.frombuffer(buf, dtype=np.float64, count=3*nvars,
+                                 offset=pos).reshape(nvars, 3)
+            rec["min"] = vals[:, 0]
+            rec["max"] = vals[:, 1]
+            rec["integral"] = vals[:, 2]
+
+        records.append(rec)
+        pos = end
+
+    return KINDS[kind], names, records
+
+
+if __name__ == "__main__":
+
+    if len(sys.argv) != 2:
+        sys.exit("usage: read_insitu.py file")
+
+    kind, names, records = read_insitu(sys.argv[1])
+
+    print(f"{kind} output for variables: {' '.join(names)}")
+    print(f"{len(records)} records")
+
+    for rec in records:
+        if kind == "reductions":
+            vals = "  ".join(f"{n}: [{mn:.6g}, {mx:.6g}] {s:.6g}"
+                             for n, mn, mx, s in zip(names, rec["min"], rec["max"], rec["integral"]))
+            print(f"step {rec['step']:6d}  time {rec['time']:.6g}  {vals}")
+        else:
+            print(f"step {rec['step']:6d}  time {rec['time']:.6g}  shape {rec['data'].shape}")